@@ -0,0 +1,10 @@
+// Declarations of the bindless resource table (set 1, see: src/vki/vulkan_bindless.h).
+// Include after #version; index with nonuniformEXT() when the index is not dynamically uniform.
+
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(set = 1, binding = 0) uniform sampler2D bindless_textures[];
+
+layout(set = 1, binding = 1) readonly buffer BindlessBuffer {
+    uint data[];
+} bindless_buffers[];
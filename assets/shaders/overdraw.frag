@@ -0,0 +1,10 @@
+#version 450
+
+// Overdraw heatmap: every fragment adds a small constant (with additive blending and no depth test), so brightness is proportional to the number of fragments shaded per pixel. Red saturates after ~4 layers, green after ~10, blue after ~25.
+
+layout(location = 0) in vec3 fragColor;
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    outColor = vec4(0.25, 0.1, 0.04, 1.0);
+}
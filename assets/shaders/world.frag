@@ -1,8 +1,15 @@
 #version 450
 
+// Must match vki::FrameData (std140, 16 bytes):
+layout(set = 0, binding = 0) uniform FrameData {
+    vec4 time; // x: seconds since start
+} frame;
+
 layout(location = 0) in vec3 fragColor;
 layout(location = 0) out vec4 outColor;
 
 void main() {
-    outColor = vec4(fragColor, 1.0);
+    // A slow brightness pulse over simulated time:
+    float pulse = 0.9 + 0.1 * sin(frame.time.x);
+    outColor = vec4(fragColor * pulse, 1.0);
 }
\ No newline at end of file
@@ -1,17 +1,16 @@
 #version 450
 
-layout(binding = 0) uniform UniformBufferObject {
-    mat4 model;
-    mat4 view;
-    mat4 proj;
-} ubo;
+layout(push_constant) uniform PushConstants {
+    mat4 view_projection; // multiplied once per frame on the CPU
+} pc;
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
+layout(location = 2) in mat4 inModel; // per-instance, occupies locations 2-5
 
 layout(location = 0) out vec3 fragColor;
 
 void main() {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
+    gl_Position = pc.view_projection * (inModel * vec4(inPosition, 1.0));
     fragColor = inColor;
 }
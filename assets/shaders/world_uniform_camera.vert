@@ -0,0 +1,20 @@
+#version 450
+
+// The transform path that the view-projection push constant replaced (see: vki::WorldTransformPath::Uniform); only used for timing comparisons.
+
+// Must match vki::CameraData (std140):
+layout(set = 0, binding = 1) uniform CameraData {
+    mat4 view;
+    mat4 projection;
+} camera;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+layout(location = 2) in mat4 inModel; // per-instance, occupies locations 2-5
+
+layout(location = 0) out vec3 fragColor;
+
+void main() {
+    gl_Position = camera.projection * camera.view * inModel * vec4(inPosition, 1.0);
+    fragColor = inColor;
+}
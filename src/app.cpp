@@ -1,10 +1,19 @@
 #include "app.h"
 
+#include <charconv>
+#include <string_view>
+#include <thread>
+
+#include "error.h"
+
 /*------------------------------------------------------------------*/
 // Constants:
 
 const std::string CONFIG_FILENAME = "config.json";
 
+// Upper bound for how long the main thread sleeps before retrying to forward input the render thread had no room for (events wake it immediately):
+const double EVENT_WAIT_TIMEOUT = 0.01; // In seconds.
+
 const std::string TITLE = "red-corner-lounge.";
 const std::tuple VERSION = std::make_tuple(2021, 2, 9);
 const std::string VERSION_STR = fmt::format(
@@ -16,25 +25,125 @@ const std::string VERSION_STR = fmt::format(
 
 /*------------------------------------------------------------------*/
 
-int App::run()
+LaunchOptions parse_launch_options(const int argc, const char* const* argv)
+{
+    LaunchOptions options;
+
+    auto parse_value = [&](int& i) -> std::string_view
+    {
+        if (i + 1 >= argc)
+            THROW_ERROR("missing value for {}", argv[i]);
+        return argv[++i];
+    };
+
+    auto parse_uint = [&](int& i, const uint64_t max = UINT32_MAX) -> uint64_t
+    {
+        const std::string_view name = argv[i];
+        const std::string_view value = parse_value(i);
+        uint64_t result = 0;
+        const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), result);
+        if (ec != std::errc {} || end != value.data() + value.size() || result > max)
+            THROW_ERROR("invalid value for {}: {}", name, value);
+        return result;
+    };
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        if (arg == "--headless")
+            options.headless = true;
+        else if (arg == "--frames")
+            options.frame_count = static_cast<uint32_t>(parse_uint(i));
+        else if (arg == "--width")
+            options.width = static_cast<uint32_t>(parse_uint(i));
+        else if (arg == "--height")
+            options.height = static_cast<uint32_t>(parse_uint(i));
+        else if (arg == "--scene")
+            options.scene = vki::parse_scene_preset(parse_value(i));
+        else if (arg == "--seed")
+            options.seed = parse_uint(i, UINT64_MAX);
+        else if (arg == "--record")
+            options.record_filename = parse_value(i);
+        else if (arg == "--replay")
+            options.replay_filename = parse_value(i);
+        else if (!arg.starts_with("--dt-")) // doctest's options are parsed before (see: main.cpp).
+            THROW_ERROR("unknown option: {}", arg);
+    }
+
+    if (!options.record_filename.empty() && !options.replay_filename.empty())
+        THROW_ERROR("--record and --replay cannot be combined");
+
+    return options;
+}
+
+int App::run(const LaunchOptions& options)
 {
     int exit_code = EXIT_SUCCESS;
 
     /*------------------------------------------------------------------*/
     // Startup/Initialization:
+    profiler::set_thread_name("main");
     try
     {
+        PROFILE_SCOPE("startup");
+
         config.load(CONFIG_FILENAME);
+        set_log_level(config.log_level);
+        profiler::set_enabled(config.profiler_enabled);
+        simulation_clock = SimulationClock { config.simulation_rate };
+
+        // From here on, logging calls do not wait for console or file I/O:
+        init_async_logger(static_cast<size_t>(config.log_queue_size), config.log_overflow_policy);
 
-        create_window();
+        if (!options.record_filename.empty())
+            input_recorder = std::make_unique<input_recording::InputRecorder>(options.record_filename);
+        if (!options.replay_filename.empty())
+        {
+            input_replayer = std::make_unique<input_recording::InputReplayer>(options.replay_filename);
+            LOG_INFO("replaying {} frames from '{}'", input_replayer->get_frame_count(), options.replay_filename);
+        }
 
+        // Headless rendering neither initializes GLFW nor creates a window:
+        if (!options.headless)
+            create_window();
+
+        // Stress scenes are generated on the CPU and uploaded by the renderer:
+        vki::Scene scene;
+        if (options.scene != vki::ScenePreset::Test)
+        {
+            PROFILE_SCOPE("generate scene");
+            scene = vki::generate_stress_scene(vki::StressSceneCreateInfo {
+                .object_count   = vki::get_object_count(options.scene),
+                .seed           = options.seed,
+            });
+        }
+
+        const vk::Extent2D headless_extent {
+            .width  = options.width  ? options.width  : static_cast<uint32_t>(config.window_width),
+            .height = options.height ? options.height : static_cast<uint32_t>(config.window_height),
+        };
         const VulkanRendererInitInfo vulkan_renderer_init_info {
             .config                 = config,
             .application_name       = TITLE,
             .application_version    = VERSION,
-            .window                 = window.get()
+            .window                 = options.headless ? vkfw::Window {} : window.get(),
+            .headless_extent        = headless_extent,
+            .scene                  = options.scene != vki::ScenePreset::Test ? &scene : nullptr,
         };
         vulkan_renderer.init(vulkan_renderer_init_info);
+
+        // Metrics are optional; failing to serve them is not fatal:
+        if (!config.metrics_endpoint.empty())
+        {
+            try
+            {
+                metrics_exporter.start(config.metrics_endpoint);
+            }
+            catch (const std::exception& e)
+            {
+                LOG_ERROR("metrics exporter could not be started: {}", e.what());
+            }
+        }
     }
     catch (const std::exception& e)
     {
@@ -47,7 +156,10 @@ int App::run()
     // Main-loop:
     try
     {
-        main_loop();
+        if (options.headless)
+            headless_loop(options.frame_count);
+        else
+            main_loop();
     }
     catch (const std::exception& e)
     {
@@ -61,6 +173,10 @@ int App::run()
     try
     {
         config.save(CONFIG_FILENAME);
+        write_profiler_trace();
+
+        if (input_recorder)
+            LOG_INFO("recorded input of {} frames to '{}'", input_recorder->get_frame_count(), options.record_filename);
     }
     catch (const std::exception& e)
     {
@@ -73,6 +189,8 @@ int App::run()
 
 void App::create_window()
 {
+    PROFILE_FUNCTION();
+
     // Init GLFW:
     glfw_instance = vkfw::initUnique();
 
@@ -87,11 +205,27 @@ void App::create_window()
     // Create:
     window = vkfw::createWindowUnique(window_width, window_height, window_title.c_str(), hints);
 
-    // Window callbacks:
+    // Window callbacks (resizes are forwarded to the render thread by the main loop, and recorded there):
     window->callbacks()->on_window_resize =
         [this](vkfw::DynamicCallbackStorage::window_type, const size_t width, const size_t height)
     {
-        this->on_resize(static_cast<int>(width), static_cast<int>(height));
+        this->pending_resizes.push_back({ static_cast<int32_t>(width), static_cast<int32_t>(height) });
+    };
+
+    // Background windows render at a reduced rate, minimized ones not at all:
+    window->callbacks()->on_window_focus =
+        [this](vkfw::DynamicCallbackStorage::window_type, const bool focused)
+    {
+        this->window_focused = focused;
+    };
+    window->callbacks()->on_window_iconify =
+        [this](vkfw::DynamicCallbackStorage::window_type, const bool iconified)
+    {
+        {
+            std::lock_guard lock { this->render_thread_mutex };
+            this->window_minimized = iconified;
+        }
+        this->render_thread_wake.notify_one();
     };
 }
 
@@ -103,21 +237,232 @@ using Time = std::chrono::duration<float, std::deca>;
 
 void App::main_loop()
 {
-    Clock clock;
-    Time previous = clock.now().time_since_epoch();
-    
-    while (!window->shouldClose())
+    // Rendering runs on its own thread; this thread only handles window events and forwards input snapshots and resizes to it, so that neither can stall the other:
+    render_thread_stop = false;
+    render_thread_finished = false;
+    std::thread render_thread { [this] { render_loop(); } };
+
+    input_recording::FrameInput pending; // Input not yet accepted by the render thread.
+    bool has_pending = false;
+    uint32_t sent_keys = 0;
+
+    while (!window->shouldClose() && !render_thread_finished.load(std::memory_order_acquire))
     {
-        vkfw::pollEvents();
+        // Input and resizes arrive as events, and the render thread posts an empty event when it finishes, so this thread only needs to wake up by itself to retry pending input:
+        {
+            PROFILE_SCOPE("waitEvents");
+            if (has_pending)
+                vkfw::waitEventsTimeout(EVENT_WAIT_TIMEOUT);
+            else
+                vkfw::waitEvents();
+        }
+
+        // Merged while the queue is full, so that no resize is lost and the latest key state wins:
+        uint32_t keys = 0;
         if (window->getKey(vkfw::Key::eEscape))
-            window->setShouldClose(true);
+            keys |= static_cast<uint32_t>(input_recording::Key::Escape);
+        if (window->getKey(vkfw::Key::eF12))
+            keys |= static_cast<uint32_t>(input_recording::Key::F12);
+
+        if (keys != (has_pending ? pending.keys : sent_keys) || !pending_resizes.empty())
+        {
+            pending.keys = keys;
+            pending.resizes.insert(pending.resizes.end(), pending_resizes.begin(), pending_resizes.end());
+            pending_resizes.clear();
+            has_pending = true;
+        }
+
+        if (has_pending && input_queue.try_push(std::move(pending)))
+        {
+            sent_keys = keys;
+            pending = {};
+            has_pending = false;
+        }
+    }
+
+    {
+        std::lock_guard lock { render_thread_mutex };
+        render_thread_stop = true;
+    }
+    render_thread_wake.notify_one();
+    render_thread.join();
+
+    if (render_thread_exception)
+        std::rethrow_exception(std::exchange(render_thread_exception, nullptr));
+}
+
+void App::render_loop()
+{
+    profiler::set_thread_name("render");
+
+    try
+    {
+        Clock clock;
+        Time previous = clock.now().time_since_epoch();
+
+        uint32_t keys = 0; // Latest snapshot of the main thread.
+        bool trace_key_was_down = false;
+
+        while (!render_thread_stop.load(std::memory_order_acquire))
+        {
+            // Nothing is visible while minimized; sleep until restored (resizes and input stay queued until then):
+            if (window_minimized.load(std::memory_order_acquire))
+            {
+                PROFILE_SCOPE("minimized");
+                std::unique_lock lock { render_thread_mutex };
+                render_thread_wake.wait(lock, [this] { return render_thread_stop || !window_minimized; });
+
+                // The simulation does not advance while minimized:
+                previous = clock.now().time_since_epoch();
+                continue;
+            }
+
+            PROFILE_SCOPE("frame");
+
+            // Pace first, then wait for the GPU, and only then sample input: any waiting happens before the input is taken, instead of between taking it and recording the frame.
+            // A window without an extent renders nothing, but is throttled like a background window:
+            const bool foreground = window_focused.load(std::memory_order_relaxed) && vulkan_renderer.has_extent();
+            frame_pacer.wait(foreground ? config.fps_limit : config.unfocused_fps_limit);
+            vulkan_renderer.wait_for_frame();
+
+            Time current = clock.now().time_since_epoch();
+            const float elapsed_time = (current - previous).count();
+            previous = current;
+
+            // Drain the input queue; a frame uses the latest key state and all resizes in order:
+            input_recording::FrameInput input;
+            for (input_recording::FrameInput packet; input_queue.try_pop(packet);)
+            {
+                keys = packet.keys;
+                input.resizes.insert(input.resizes.end(), packet.resizes.begin(), packet.resizes.end());
+            }
+            input.keys = keys;
+            input.elapsed_time = elapsed_time;
+
+            if (!process_frame_input(input))
+            {
+                LOG_INFO("replay finished");
+                break;
+            }
+
+            for (const auto& resize : input.resizes)
+                on_resize(resize.width, resize.height);
+
+            // May be called from any thread:
+            if (input.is_down(input_recording::Key::Escape))
+            {
+                window->setShouldClose(true);
+                vkfw::postEmptyEvent(); // The main thread may be blocked waiting for events.
+            }
+
+            // Write a trace on demand (once per key press):
+            const bool trace_key_down = input.is_down(input_recording::Key::F12);
+            if (trace_key_down && !trace_key_was_down)
+                write_profiler_trace();
+            trace_key_was_down = trace_key_down;
+
+            const float interpolation = advance_simulation(input.elapsed_time);
+            vulkan_renderer.update(input.elapsed_time, interpolation);
+            frame_pacer.on_present();
+
+            if (metrics_exporter.is_running())
+            {
+                metrics_exporter.record_frame(input.elapsed_time * 10.0); // elapsed_time is in decaseconds.
+                if (metrics_exporter.is_publish_due())
+                    publish_metrics();
+            }
+        }
+    }
+    catch (...)
+    {
+        // Rethrown by the main thread:
+        render_thread_exception = std::current_exception();
+    }
+
+    render_thread_finished.store(true, std::memory_order_release);
+    vkfw::postEmptyEvent(); // Wakes the main thread.
+}
+
+void App::headless_loop(uint32_t frame_count)
+{
+    Clock clock;
+    const auto start = clock.now();
+    Time previous = start.time_since_epoch();
+
+    // A replay determines the number of frames:
+    if (input_replayer)
+        frame_count = static_cast<uint32_t>(input_replayer->get_frame_count());
+
+    for (uint32_t i = 0; i != frame_count; ++i)
+    {
+        PROFILE_SCOPE("frame");
 
         Time current = clock.now().time_since_epoch();
         const float elapsed_time = (current - previous).count();
         previous = current;
 
-        vulkan_renderer.update(elapsed_time);
-    };
+        input_recording::FrameInput input { .elapsed_time = elapsed_time };
+        if (!process_frame_input(input))
+            break;
+
+        for (const auto& resize : input.resizes)
+            on_resize(resize.width, resize.height);
+
+        const float interpolation = advance_simulation(input.elapsed_time);
+        vulkan_renderer.update(input.elapsed_time, interpolation);
+
+        if (metrics_exporter.is_running())
+        {
+            metrics_exporter.record_frame(input.elapsed_time * 10.0); // elapsed_time is in decaseconds.
+            if (metrics_exporter.is_publish_due())
+                publish_metrics();
+        }
+    }
+
+    const std::chrono::duration<double> total = clock.now() - start;
+    if (frame_count != 0)
+    {
+        LOG_INFO("headless: {} frames in {:.3f} s (average frame time: {:.3f} ms, {:.1f} fps)",
+            frame_count, total.count(), total.count() * 1e3 / frame_count, frame_count / total.count());
+    }
+}
+
+float App::advance_simulation(const float elapsed_time)
+{
+    PROFILE_FUNCTION();
+
+    // A replay feeds the recorded frame times, so that it reproduces the same simulation steps:
+    const uint64_t dropped_step_count = simulation_clock.get_dropped_step_count();
+    const uint32_t steps = simulation_clock.advance(elapsed_time * 10.0); // elapsed_time is in decaseconds.
+    for (uint32_t i = 0; i != steps; ++i)
+        vulkan_renderer.simulate(simulation_clock.get_step());
+
+    if (simulation_clock.get_dropped_step_count() != dropped_step_count)
+        LOG_WARNING_EVERY_MS(5000, "simulation fell behind real time; {} steps dropped so far", simulation_clock.get_dropped_step_count());
+
+    return static_cast<float>(simulation_clock.get_alpha());
+}
+
+bool App::process_frame_input(input_recording::FrameInput& input)
+{
+    using input_recording::Key;
+
+    if (input_replayer)
+    {
+        // Live resizes are dropped in favor of the recorded ones; the swapchain still follows the actual window size.
+        // Escape still ends a replay early:
+        const bool escape = input.is_down(Key::Escape);
+        if (!input_replayer->next_frame(input))
+            return false;
+        if (escape)
+            input.keys |= static_cast<uint32_t>(Key::Escape);
+        return true;
+    }
+
+    if (input_recorder)
+        input_recorder->record_frame(input);
+
+    return true;
 }
 
 void App::on_resize(const int width, const int height)
@@ -126,4 +471,60 @@ void App::on_resize(const int width, const int height)
 
     config.window_width  = width;
     config.window_height = height;
+
+    vulkan_renderer.on_resize(width, height);
+}
+
+void App::write_profiler_trace()
+{
+    if (!config.profiler_enabled || config.profiler_trace_filename.empty())
+        return;
+
+    try
+    {
+        profiler::write_chrome_trace(config.profiler_trace_filename);
+    }
+    catch (const std::exception& e)
+    {
+        LOG_ERROR("profiler trace could not be written: {}", e.what());
+    }
+}
+
+void App::publish_metrics()
+{
+    std::vector<MetricsSnapshot::GpuRegion> gpu_regions;
+    for (const auto& stats : vulkan_renderer.get_gpu_stats())
+    {
+        gpu_regions.push_back(MetricsSnapshot::GpuRegion {
+            .name           = stats.name,
+            .p50_seconds    = stats.p50_ms * 1e-3,
+            .p95_seconds    = stats.p95_ms * 1e-3,
+            .p99_seconds    = stats.p99_ms * 1e-3,
+        });
+    }
+    metrics_exporter.record_present_timing(frame_pacer.get_present_interval_ms() * 1e-3, frame_pacer.get_present_jitter_ms() * 1e-3);
+    metrics_exporter.publish(std::move(gpu_regions), vulkan_renderer.get_total_stats());
+}
+
+/*------------------------------------------------------------------*/
+// doctest:
+
+#include <doctest/doctest.h>
+
+TEST_CASE("testing launch option parsing")
+{
+    const char* args[] = { "rcl", "--headless", "--frames", "120", "--dt-no-breaks", "--width", "640", "--scene", "10k", "--seed", "12345678901" };
+    const auto options = parse_launch_options(static_cast<int>(std::size(args)), args);
+    CHECK(options.headless);
+    CHECK(options.frame_count == 120);
+    CHECK(options.width == 640);
+    CHECK(options.height == 0);
+    CHECK(options.scene == vki::ScenePreset::Objects10k);
+    CHECK(options.seed == 12345678901ull);
+
+    const char* invalid[] = { "rcl", "--frames", "12x" };
+    CHECK_THROWS(parse_launch_options(static_cast<int>(std::size(invalid)), invalid));
+
+    const char* unknown[] = { "rcl", "--headles" };
+    CHECK_THROWS(parse_launch_options(static_cast<int>(std::size(unknown)), unknown));
 }
\ No newline at end of file
@@ -1,30 +1,89 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+
 #include <fmt/format.h>
 #include <vkfw/vkfw.hpp>
 
 #include "log.h"
 #include "config.h"
+#include "profiler.h"
+#include "metrics_exporter.h"
+#include "input_recording.h"
+#include "spsc_queue.h"
+#include "simulation_clock.h"
+#include "frame_pacer.h"
 #include "vki/vulkan_interface.h"
 
+/*------------------------------------------------------------------*/
+// LaunchOptions:
+
+struct LaunchOptions
+{
+    bool     headless       = false;    // --headless: render offscreen without a window (no GLFW required).
+    uint32_t frame_count    = 1000;     // --frames N: number of frames rendered in headless mode.
+    uint32_t width          = 0;        // --width W: headless target width; 0 uses the configured window width.
+    uint32_t height         = 0;        // --height H: headless target height; 0 uses the configured window height.
+    vki::ScenePreset scene  = vki::ScenePreset::Test; // --scene test|1k|10k|100k|1m: see vki::generate_stress_scene().
+    uint64_t seed           = 1;        // --seed S: of the stress scene.
+    std::string record_filename;        // --record FILE: records per-frame input (see: input_recording.h).
+    std::string replay_filename;        // --replay FILE: replays recorded input instead of sampling it; the run ends with the recording.
+};
+// Arguments with doctest's "--dt-" prefix are skipped. Throws on unknown options and malformed values.
+LaunchOptions parse_launch_options(const int argc, const char* const* argv);
+
 /*------------------------------------------------------------------*/
 // App:
 
 class App
 {
 public:
-    int run();
+    int run(const LaunchOptions& options = {});
 
 private:
     void create_window();
 
-    void main_loop();
+    void main_loop();   // Handles window events; runs render_loop() on a separate thread.
+    void render_loop();
+    void headless_loop(uint32_t frame_count); // Renders on the calling thread.
+
+    // Records the frame's live input, or replaces it with the replayed frame. Returns false once the replay has ended.
+    bool process_frame_input(input_recording::FrameInput& input);
+
+    // Runs the fixed simulation steps due after elapsed_time (in decaseconds). Returns the interpolation for rendering.
+    float advance_simulation(const float elapsed_time);
 
     void on_resize(const int width, const int height);
 
+    void write_profiler_trace();
+    void publish_metrics();
+
 private:
     Config config;
     vkfw::UniqueInstance glfw_instance;
     vkfw::UniqueWindow window;
     VulkanRenderer vulkan_renderer;
+    MetricsExporter metrics_exporter;
+    SimulationClock simulation_clock; // Only used by the thread that renders.
+    FramePacer      frame_pacer;      // Only used by the render thread.
+
+    std::unique_ptr<input_recording::InputRecorder> input_recorder;
+    std::unique_ptr<input_recording::InputReplayer> input_replayer;
+    std::vector<input_recording::Resize>            pending_resizes; // Of the window callback; forwarded to the render thread by the main loop.
+
+    // Main thread to render thread. Small, so that input reaches the renderer within a few frames even if the main thread runs ahead:
+    SpscQueue<input_recording::FrameInput, 4>   input_queue;
+    std::atomic<bool>                           render_thread_stop { false };
+    std::atomic<bool>                           render_thread_finished { false };
+    std::exception_ptr                          render_thread_exception; // Read by the main thread after joining.
+
+    // Window state, written by the main thread's callbacks. The render thread sleeps on render_thread_wake while the window is minimized; changes to window_minimized and render_thread_stop are made under render_thread_mutex, so that no wake-up is lost:
+    std::atomic<bool>                           window_focused { true };
+    std::atomic<bool>                           window_minimized { false };
+    std::mutex                                  render_thread_mutex;
+    std::condition_variable                     render_thread_wake;
 };
\ No newline at end of file
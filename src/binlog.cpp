@@ -0,0 +1,340 @@
+#include "binlog.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "log.h"
+#include "error.h"
+#include "utility.h"
+
+namespace binlog
+{
+/*------------------------------------------------------------------*/
+// Constants:
+
+const size_t RING_SIZE = 64 * 1024; // Per thread; must be a power of two.
+const uint32_t MAX_SITES = 4096;
+const auto DRAIN_INTERVAL = std::chrono::milliseconds(10);
+
+static_assert((RING_SIZE & (RING_SIZE - 1)) == 0);
+
+/*------------------------------------------------------------------*/
+// Ring:
+
+// Single-producer (the owning thread), single-consumer (the drain thread) byte ring.
+struct Ring
+{
+    std::unique_ptr<std::byte[]>    data { new std::byte[RING_SIZE] };
+    std::atomic<uint64_t>           head { 0 }; // Written by the producer.
+    std::atomic<uint64_t>           tail { 0 }; // Written by the consumer.
+    std::atomic<bool>               exited { false }; // Set when the producer's thread exits; it writes no more records.
+
+    void copy_in(uint64_t position, const std::byte* src, size_t size)
+    {
+        const size_t offset = position & (RING_SIZE - 1);
+        const size_t first  = std::min(size, RING_SIZE - offset);
+        std::memcpy(data.get() + offset, src, first);
+        std::memcpy(data.get(), src + first, size - first);
+    }
+
+    void copy_out(uint64_t position, std::byte* dst, size_t size) const
+    {
+        const size_t offset = position & (RING_SIZE - 1);
+        const size_t first  = std::min(size, RING_SIZE - offset);
+        std::memcpy(dst, data.get() + offset, first);
+        std::memcpy(dst + first, data.get(), size - first);
+    }
+};
+
+/*------------------------------------------------------------------*/
+// State:
+
+struct State
+{
+    std::mutex                          mutex; // Guards registration of sites and rings, and the drain thread.
+    std::unique_ptr<Site[]>             sites { new Site[MAX_SITES] }; // Fixed, so that the drain thread may read registered sites without locking.
+    uint32_t                            site_count = 0;
+    std::vector<std::shared_ptr<Ring>>  rings;
+
+    std::thread                         drain_thread;
+    std::condition_variable             drain_cv;
+    bool                                running = false;
+
+    std::atomic<uint64_t>               dropped { 0 };
+    const int64_t                       start_timestamp = get_timestamp();
+};
+
+State& get_state()
+{
+    static State state;
+    return state;
+}
+
+Ring& get_thread_ring()
+{
+    // Rings are shared with the state, so that records of exited threads can still be drained. On exit, the thread marks its ring, which is then freed by the next drain (see: drain_all()):
+    struct Owner
+    {
+        std::shared_ptr<Ring> ring;
+
+        ~Owner()
+        {
+            ring->exited.store(true, std::memory_order_release);
+        }
+    };
+
+    thread_local Owner owner { []
+    {
+        auto& state = get_state();
+        auto new_ring = std::make_shared<Ring>();
+
+        std::lock_guard lock { state.mutex };
+        state.rings.push_back(new_ring);
+        return new_ring;
+    }() };
+    return *owner.ring;
+}
+
+/*------------------------------------------------------------------*/
+
+uint32_t register_site(const Site& site)
+{
+    auto& state = get_state();
+    std::lock_guard lock { state.mutex };
+
+    if (state.site_count == MAX_SITES)
+        THROW_ERROR("too many binlog sites; maximum: {}", MAX_SITES);
+
+    state.sites[state.site_count] = site;
+    return state.site_count++;
+}
+
+int64_t get_timestamp()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void write_record(const RecordHeader& header, const std::byte* payload)
+{
+    auto& ring = get_thread_ring();
+
+    const size_t record_size = sizeof(RecordHeader) + header.payload_size;
+    const uint64_t head = ring.head.load(std::memory_order_relaxed);
+    const uint64_t tail = ring.tail.load(std::memory_order_acquire);
+
+    if (head + record_size - tail > RING_SIZE)
+    {
+        get_state().dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    ring.copy_in(head, reinterpret_cast<const std::byte*>(&header), sizeof(RecordHeader));
+    ring.copy_in(head + sizeof(RecordHeader), payload, header.payload_size);
+    ring.head.store(head + record_size, std::memory_order_release);
+}
+
+// Formats all available records of a ring and forwards them to the default logger.
+void drain_ring(Ring& ring, const Site* sites, const int64_t start_timestamp)
+{
+    uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    const uint64_t head = ring.head.load(std::memory_order_acquire);
+
+    // Records below the runtime level are dropped without being formatted:
+    const bool enabled = spdlog::default_logger_raw()->should_log(spdlog::level::trace);
+
+    std::vector<std::byte> payload;
+    while (tail != head)
+    {
+        RecordHeader header;
+        ring.copy_out(tail, reinterpret_cast<std::byte*>(&header), sizeof(RecordHeader));
+
+        const uint64_t payload_tail = tail + sizeof(RecordHeader);
+        tail = payload_tail + header.payload_size;
+        if (!enabled)
+            continue;
+
+        payload.resize(header.payload_size);
+        ring.copy_out(payload_tail, payload.data(), header.payload_size);
+
+        const auto& site = sites[header.site_id];
+        try
+        {
+            const auto message = site.format_payload(site.format, payload.data());
+            const double elapsed_ms = (header.timestamp - start_timestamp) * 1e-6;
+            spdlog::default_logger_raw()->log(
+                spdlog::source_loc { site.file, site.line, "" },
+                spdlog::level::trace,
+                "[binlog +{:.3f}ms] {}", elapsed_ms, message);
+        }
+        catch (const std::exception& e)
+        {
+            LOG_ERROR("binlog record could not be formatted; format: '{}', exception: {}", site.format, e.what());
+        }
+    }
+
+    ring.tail.store(tail, std::memory_order_release);
+}
+
+void drain_all()
+{
+    auto& state = get_state();
+
+    // Copy under lock, so that registration is never blocked by formatting:
+    std::vector<std::shared_ptr<Ring>> rings;
+    {
+        std::lock_guard lock { state.mutex };
+        rings = state.rings;
+    }
+
+    // Sites are only ever appended, and every site referenced by a record was registered before the record was written:
+    std::vector<const Ring*> exited_rings;
+    for (auto& ring : rings)
+    {
+        // Checked before draining: the ring of an exited thread already holds its last record, so this drain empties it for good:
+        const bool exited = ring->exited.load(std::memory_order_acquire);
+        drain_ring(*ring, state.sites.get(), state.start_timestamp);
+        if (exited)
+            exited_rings.push_back(ring.get());
+    }
+
+    // Free the rings of exited threads, so that short-lived threads do not accumulate them:
+    if (!exited_rings.empty())
+    {
+        std::lock_guard lock { state.mutex };
+        std::erase_if(state.rings, [&](const auto& ring) { return contains(exited_rings, static_cast<const Ring*>(ring.get())); });
+    }
+}
+
+void start()
+{
+    auto& state = get_state();
+    std::lock_guard lock { state.mutex };
+
+    if (state.running)
+        return;
+    state.running = true;
+
+    state.drain_thread = std::thread { []
+    {
+        auto& state = get_state();
+        std::unique_lock lock { state.mutex };
+        while (state.running)
+        {
+            state.drain_cv.wait_for(lock, DRAIN_INTERVAL);
+
+            lock.unlock();
+            drain_all();
+            lock.lock();
+        }
+    } };
+}
+
+void stop()
+{
+    auto& state = get_state();
+    {
+        std::lock_guard lock { state.mutex };
+        if (!state.running)
+            return;
+        state.running = false;
+    }
+    state.drain_cv.notify_all();
+    state.drain_thread.join();
+
+    // Whatever was written after the last drain:
+    drain_all();
+
+    const auto dropped = get_dropped_count();
+    if (dropped)
+        LOG_WARNING("binlog records dropped due to full ring buffers: {}", dropped);
+}
+
+uint64_t get_dropped_count()
+{
+    return get_state().dropped.load(std::memory_order_relaxed);
+}
+}
+
+/*------------------------------------------------------------------*/
+// doctest:
+
+#include <doctest/doctest.h>
+
+TEST_CASE("testing binlog payload formatting")
+{
+    struct Payload
+    {
+        int     i;
+        float   f;
+        char    c;
+    } payload_values { 42, 0.5f, 'x' };
+
+    std::byte payload[sizeof(int) + sizeof(float) + sizeof(char)];
+    std::memcpy(payload, &payload_values.i, sizeof(int));
+    std::memcpy(payload + sizeof(int), &payload_values.f, sizeof(float));
+    std::memcpy(payload + sizeof(int) + sizeof(float), &payload_values.c, sizeof(char));
+
+    CHECK(binlog::format_payload<int, float, char>("{} {} {}", payload) == "42 0.5 x");
+    CHECK(binlog::format_payload<>("no arguments", nullptr) == "no arguments");
+}
+
+#include <spdlog/sinks/ostream_sink.h>
+
+#include <cstdio>
+#include <sstream>
+
+TEST_CASE("testing binlog rings")
+{
+    auto& state = binlog::get_state();
+    const size_t ring_count = state.rings.size();
+
+    // Capture the drained messages:
+    std::ostringstream output;
+    const auto sink = std::make_shared<spdlog::sinks::ostream_sink_st>(output);
+    sink->set_pattern("%v");
+    const auto previous_logger = spdlog::default_logger();
+    const auto logger = std::make_shared<spdlog::logger>("binlog test", sink);
+    logger->set_level(spdlog::level::trace);
+    spdlog::set_default_logger(logger);
+
+    const int RECORD_COUNT = 100;
+    auto write_records = [](const int thread)
+    {
+        for (int i = 0; i != RECORD_COUNT; ++i)
+            BINLOG("thread {} record {} of {}", thread, i, 0.5 * i);
+    };
+    std::thread a { write_records, 0 };
+    std::thread b { write_records, 1 };
+    a.join();
+    b.join();
+
+    binlog::drain_all();
+    spdlog::set_default_logger(previous_logger);
+
+    // Both rings were drained completely, each in its own order:
+    int next_record[2] = { 0, 0 };
+    std::istringstream lines { output.str() };
+    for (std::string line; std::getline(lines, line);)
+    {
+        int thread = -1;
+        int record = -1;
+        double value = 0.0;
+        const auto message = line.substr(line.find("] ") + 2);
+        REQUIRE(std::sscanf(message.c_str(), "thread %d record %d of %lf", &thread, &record, &value) == 3);
+        REQUIRE((thread == 0 || thread == 1));
+        CHECK(record == next_record[thread]);
+        CHECK(value == 0.5 * record);
+        next_record[thread] = record + 1;
+    }
+    CHECK(next_record[0] == RECORD_COUNT);
+    CHECK(next_record[1] == RECORD_COUNT);
+
+    // The threads have exited, so their rings were freed:
+    CHECK(state.rings.size() == ring_count);
+    CHECK(binlog::get_dropped_count() == 0);
+}
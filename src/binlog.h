@@ -0,0 +1,125 @@
+#pragma once
+
+#include <fmt/format.h>
+
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+/*------------------------------------------------------------------*/
+// Binary log channel:
+// BINLOG("draw {}: {} instances", draw_index, instance_count);
+// The format string and argument types of each call site are registered once; afterwards a call only copies the site id, a timestamp and the raw argument bytes into a per-thread ring buffer. Formatting is deferred to a background drain thread, which forwards the formatted messages to the default logger (at trace level).
+// Arguments must be trivially copyable and must not be pointers (pointees would be gone by the time the message is formatted). The format string must be a string literal.
+
+#define BINLOG(...)                                                                                 \
+    do                                                                                              \
+    {                                                                                               \
+        static const uint32_t binlog_site_id_ = ::binlog::register_site(                            \
+            decltype(::binlog::deduce_arg_types(__VA_ARGS__)) {}, __FILE__, __LINE__, __VA_ARGS__); \
+        ::binlog::write(binlog_site_id_, __VA_ARGS__);                                              \
+    } while (false)
+
+namespace binlog
+{
+/*------------------------------------------------------------------*/
+// Sites:
+
+template<typename... Args>
+struct ArgTypes {};
+
+// Only used in unevaluated context; deduces the (decayed) argument types of a call site.
+template<typename Format, typename... Args>
+ArgTypes<std::decay_t<Args>...> deduce_arg_types(const Format&, const Args&...);
+
+using FormatFunction = std::string (*)(const char* format, const std::byte* payload);
+
+struct Site
+{
+    const char*     format;
+    const char*     file;
+    int             line;
+    FormatFunction  format_payload;
+};
+
+// Reads the argument bytes written by write() back into values and formats them.
+template<typename... Args>
+std::string format_payload(const char* format, const std::byte* payload)
+{
+    size_t offset = 0;
+    [[maybe_unused]] auto read = [&]<typename T>()
+    {
+        T value;
+        std::memcpy(&value, payload + offset, sizeof(T));
+        offset += sizeof(T);
+        return value;
+    };
+
+    // Elements of a braced initializer are evaluated in order:
+    const std::tuple<Args...> values { read.template operator()<Args>()... };
+    return std::apply([format](const auto&... args)
+    {
+        return fmt::vformat(format, fmt::make_format_args(args...));
+    }, values);
+}
+
+uint32_t register_site(const Site& site);
+
+template<typename... Args>
+uint32_t register_site(ArgTypes<Args...>, const char* file, const int line, const char* format, const auto&...)
+{
+    static_assert((std::is_trivially_copyable_v<Args> && ...), "binlog arguments must be trivially copyable");
+    static_assert((!std::is_pointer_v<Args> && ...), "binlog arguments must not be pointers");
+    static_assert((std::is_default_constructible_v<Args> && ...), "binlog arguments must be default constructible");
+
+    return register_site(Site {
+        .format         = format,
+        .file           = file,
+        .line           = line,
+        .format_payload = &format_payload<Args...>,
+    });
+}
+
+/*------------------------------------------------------------------*/
+// Writing:
+
+struct RecordHeader
+{
+    uint32_t site_id;
+    uint32_t payload_size;
+    int64_t  timestamp; // Nanoseconds, steady clock.
+};
+
+int64_t get_timestamp();
+
+// Copies a record into the calling thread's ring buffer. Records are dropped (and counted) if the ring is full.
+void write_record(const RecordHeader& header, const std::byte* payload);
+
+template<typename... Args>
+inline void write(const uint32_t site_id, const char*, const Args&... args)
+{
+    constexpr size_t payload_size = (sizeof(Args) + ... + 0);
+    std::byte payload[payload_size > 0 ? payload_size : 1];
+
+    size_t offset = 0;
+    ((std::memcpy(payload + offset, &args, sizeof(Args)), offset += sizeof(Args)), ...);
+
+    const RecordHeader header {
+        .site_id        = site_id,
+        .payload_size   = static_cast<uint32_t>(payload_size),
+        .timestamp      = get_timestamp(),
+    };
+    write_record(header, payload);
+}
+
+/*------------------------------------------------------------------*/
+// Draining:
+
+// Starts/stops the background drain thread. stop() drains all remaining records.
+void start();
+void stop();
+
+uint64_t get_dropped_count();
+}
@@ -3,9 +3,12 @@
 #include <fstream>
 
 #include "log.h"
+#include "profiler.h"
 
 void Config::load(const std::string& filename)
 {
+    PROFILE_SCOPE("Config::load");
+
     LOG_INFO("loading configuration from '{}'...", filename);
 
     std::ifstream ifstr { filename };
@@ -20,6 +20,37 @@ NLOHMANN_JSON_SERIALIZE_ENUM(VulkanDebug, {
     { VulkanDebug::Verbose, "verbose" },
 })
 
+enum class PresentMode
+{
+    Fifo = 0,   // Waits for vertical blank; never tears. Always supported.
+    Mailbox,    // Replaces the queued image with the newest one at vertical blank; lower latency than Fifo without tearing, at the cost of discarded frames.
+    Immediate,  // Presents without waiting; lowest latency, but may tear.
+};
+
+NLOHMANN_JSON_SERIALIZE_ENUM(PresentMode, {
+    { PresentMode::Fifo,        "fifo" },
+    { PresentMode::Mailbox,     "mailbox" },
+    { PresentMode::Immediate,   "immediate" },
+})
+
+namespace spdlog::level
+{
+NLOHMANN_JSON_SERIALIZE_ENUM(level_enum, {
+    { trace,    "trace" },
+    { debug,    "debug" },
+    { info,     "info" },
+    { warn,     "warning" },
+    { err,      "error" },
+    { critical, "critical" },
+    { off,      "off" },
+})
+}
+
+NLOHMANN_JSON_SERIALIZE_ENUM(LogOverflowPolicy, {
+    { LogOverflowPolicy::Block,         "block" },
+    { LogOverflowPolicy::DropOldest,    "drop_oldest" },
+})
+
 /*------------------------------------------------------------------*/
 // Config:
 
@@ -28,6 +59,20 @@ struct Config
     int window_width                        = 800;
     int window_height                       = 800;
     VulkanDebug vulkan_debug                = VulkanDebug::Off;
+    spdlog::level::level_enum log_level     = spdlog::level::info;
+    int log_queue_size                      = 8192;
+    LogOverflowPolicy log_overflow_policy   = LogOverflowPolicy::Block;
+    bool profiler_enabled                   = true;
+    std::string profiler_trace_filename     = "trace.json"; // Written at exit and on F12.
+    bool diagnostics_pipeline_statistics    = false; // Logs per-pass vertex/clipping/fragment counts; requires the pipelineStatisticsQuery feature.
+    bool diagnostics_overdraw               = false; // Renders the world as an overdraw heatmap.
+    bool diagnostics_uniform_camera         = false; // Multiplies view and projection per vertex from a uniform buffer instead of pushing view-projection; only for timing comparisons (see: vki::WorldTransformPath).
+    std::string metrics_endpoint            = ""; // "unix:<path>" or "<address>:<port>" (e.g. "127.0.0.1:9464" or "localhost:9464"); empty disables the metrics exporter.
+    double simulation_rate                  = 60.0; // Fixed simulation steps per second; independent of the render rate (see: SimulationClock).
+    double fps_limit                        = 0.0; // Frame rate cap while the window has focus; 0 is unlimited.
+    double unfocused_fps_limit              = 10.0; // Frame rate cap while the window is in the background; 0 is unlimited. Nothing is rendered while minimized.
+    PresentMode present_mode                = PresentMode::Fifo; // Falls back to Fifo if not supported by the surface.
+    bool low_latency                        = false; // Keeps a single frame in flight, so that input is sampled after the GPU finished the previous frame; trades throughput for latency.
 
     void load(const std::string& filename);
     void save(const std::string& filename);
@@ -36,5 +81,19 @@ private:
     DEFINE_JSON_SERIALIZABLE(Config,
         window_width,
         window_height,
-        vulkan_debug);
+        vulkan_debug,
+        log_level,
+        log_queue_size,
+        log_overflow_policy,
+        profiler_enabled,
+        profiler_trace_filename,
+        diagnostics_pipeline_statistics,
+        diagnostics_overdraw,
+        diagnostics_uniform_camera,
+        metrics_endpoint,
+        simulation_rate,
+        fps_limit,
+        unfocused_fps_limit,
+        present_mode,
+        low_latency);
 };
\ No newline at end of file
@@ -15,4 +15,5 @@ inline constexpr size_t get_filename_offset(const T (& str)[S], size_t i = S - 1
 #define LOCATION fmt::format("{}:{}, {}", FILENAME, __LINE__, __FUNCTION__)
 
 // Throws std::runtime_error using a formatted string as message. Additionally, the location of the throw will be appended to the message.
-#define THROW_ERROR(format_str, ...) throw std::runtime_error(fmt::format(format_str, __VA_ARGS__) + " (thrown from: " + LOCATION + ')')
\ No newline at end of file
+// The format string is part of __VA_ARGS__, so that calls without arguments need no trailing comma elision (which only MSVC does for an empty __VA_ARGS__).
+#define THROW_ERROR(...) throw std::runtime_error(fmt::format(__VA_ARGS__) + " (thrown from: " + LOCATION + ')')
\ No newline at end of file
@@ -0,0 +1,254 @@
+#include "flight_recorder.h"
+
+#include <spdlog/details/log_msg.h>
+#include <spdlog/details/os.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include <fmt/format.h>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "error.h"
+#include "utility.h"
+
+namespace flight_recorder
+{
+static_assert(std::atomic_ref<uint64_t>::is_always_lock_free, "flight recorder requires lock-free 64-bit atomics");
+
+/*------------------------------------------------------------------*/
+// Writing:
+
+FlightRecorder::FlightRecorder(const std::string& path, const uint64_t record_count) :
+    path { path }
+{
+    if (record_count == 0)
+        THROW_ERROR("flight recorder needs at least one record");
+
+    mapping_size = sizeof(FileHeader) + sizeof(Record) * record_count;
+
+#if defined(_WIN32)
+    file_handle = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE)
+        THROW_ERROR("could not create '{}'; error: {}", path, GetLastError());
+
+    const uint64_t size = mapping_size;
+    mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READWRITE,
+        static_cast<DWORD>(size >> 32), static_cast<DWORD>(size & 0xFFFFFFFF), nullptr);
+    if (!mapping_handle)
+    {
+        CloseHandle(file_handle);
+        THROW_ERROR("could not create a mapping of '{}'; error: {}", path, GetLastError());
+    }
+
+    mapping = MapViewOfFile(mapping_handle, FILE_MAP_ALL_ACCESS, 0, 0, mapping_size);
+    if (!mapping)
+    {
+        CloseHandle(mapping_handle);
+        CloseHandle(file_handle);
+        THROW_ERROR("could not map '{}'; error: {}", path, GetLastError());
+    }
+#else
+    file_descriptor = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (file_descriptor < 0)
+        THROW_ERROR("could not create '{}'; error: {}", path, std::strerror(errno));
+
+    if (ftruncate(file_descriptor, static_cast<off_t>(mapping_size)) != 0)
+    {
+        close(file_descriptor);
+        THROW_ERROR("could not resize '{}'; error: {}", path, std::strerror(errno));
+    }
+
+    mapping = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, file_descriptor, 0);
+    if (mapping == MAP_FAILED)
+    {
+        mapping = nullptr;
+        close(file_descriptor);
+        THROW_ERROR("could not map '{}'; error: {}", path, std::strerror(errno));
+    }
+#endif
+
+    // The file is zero-filled, so all records start out as incomplete (sequence 0):
+    header = static_cast<FileHeader*>(mapping);
+    records = reinterpret_cast<Record*>(static_cast<char*>(mapping) + sizeof(FileHeader));
+
+    std::memcpy(header->magic, MAGIC, sizeof(MAGIC));
+    header->version         = VERSION;
+    header->record_size     = sizeof(Record);
+    header->record_count    = record_count;
+    header->next_sequence   = 1;
+}
+
+FlightRecorder::~FlightRecorder()
+{
+#if defined(_WIN32)
+    UnmapViewOfFile(mapping);
+    CloseHandle(mapping_handle);
+    CloseHandle(file_handle);
+#else
+    munmap(mapping, mapping_size);
+    close(file_descriptor);
+#endif
+}
+
+void FlightRecorder::record(const RecordKind kind, const int level, const std::string_view text, const int64_t timestamp, const uint32_t thread_id) noexcept
+{
+    const uint64_t sequence = std::atomic_ref<uint64_t> { header->next_sequence }.fetch_add(1, std::memory_order_relaxed);
+    Record& record = records[(sequence - 1) % header->record_count];
+
+    // Mark the record as incomplete while it is overwritten; a record torn by a crash is then skipped by the reader:
+    std::atomic_ref<uint64_t> record_sequence { record.sequence };
+    record_sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const size_t length = std::min(text.size(), TEXT_SIZE);
+    record.timestamp    = timestamp;
+    record.thread_id    = thread_id;
+    record.kind         = kind;
+    record.level        = static_cast<uint8_t>(level);
+    record.length       = static_cast<uint16_t>(length);
+    std::memcpy(record.text, text.data(), length);
+
+    record_sequence.store(sequence, std::memory_order_release);
+}
+
+void FlightRecorder::record(const RecordKind kind, const int level, const std::string_view text) noexcept
+{
+    const auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    record(kind, level, text, timestamp, static_cast<uint32_t>(spdlog::details::os::thread_id()));
+}
+
+/*------------------------------------------------------------------*/
+// Sink:
+
+class FlightRecorderSink final : public spdlog::sinks::sink
+{
+public:
+    explicit FlightRecorderSink(std::shared_ptr<FlightRecorder> recorder) :
+        recorder { std::move(recorder) }
+    {}
+
+    void log(const spdlog::details::log_msg& msg) override
+    {
+        const auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(msg.time.time_since_epoch()).count();
+        recorder->record(RecordKind::Log, msg.level, { msg.payload.data(), msg.payload.size() },
+            timestamp, static_cast<uint32_t>(msg.thread_id));
+    }
+
+    // The mapping is written back by the OS, even after a crash; there is nothing to flush:
+    void flush() override {}
+    void set_pattern(const std::string&) override {}
+    void set_formatter(std::unique_ptr<spdlog::formatter>) override {}
+
+private:
+    std::shared_ptr<FlightRecorder> recorder;
+};
+
+std::shared_ptr<spdlog::sinks::sink> create_flight_recorder_sink(std::shared_ptr<FlightRecorder> recorder)
+{
+    return std::make_shared<FlightRecorderSink>(std::move(recorder));
+}
+
+/*------------------------------------------------------------------*/
+// Reading:
+
+std::vector<DecodedRecord> read_records(const std::string& path, const double last_seconds)
+{
+    std::ifstream file { path, std::ios::binary };
+    if (!file)
+        THROW_ERROR("could not open '{}'", path);
+
+    FileHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0)
+        THROW_ERROR("'{}' is not a flight recorder file", path);
+    if (header.version != VERSION || header.record_size != sizeof(Record))
+        THROW_ERROR("'{}' has an unsupported version: {}", path, header.version);
+
+    std::vector<DecodedRecord> decoded;
+    Record record;
+    for (uint64_t i = 0; i < header.record_count && file.read(reinterpret_cast<char*>(&record), sizeof(record)); ++i)
+    {
+        if (record.sequence == 0)
+            continue;
+
+        decoded.push_back({
+            .sequence   = record.sequence,
+            .timestamp  = record.timestamp,
+            .thread_id  = record.thread_id,
+            .kind       = record.kind,
+            .level      = record.level,
+            .text       = { record.text, std::min<size_t>(record.length, TEXT_SIZE) },
+        });
+    }
+
+    std::sort(decoded.begin(), decoded.end(), [](const auto& a, const auto& b) { return a.sequence < b.sequence; });
+
+    if (last_seconds > 0.0 && !decoded.empty())
+    {
+        const auto newest = std::max_element(decoded.begin(), decoded.end(),
+            [](const auto& a, const auto& b) { return a.timestamp < b.timestamp; })->timestamp;
+        const auto oldest_kept = newest - static_cast<int64_t>(last_seconds * 1e9);
+        std::erase_if(decoded, [&](const auto& record) { return record.timestamp < oldest_kept; });
+    }
+
+    return decoded;
+}
+
+std::string format_record(const DecodedRecord& record)
+{
+    constexpr const char* LEVEL_NAMES[] = { "trace", "debug", "info", "warning", "error", "critical", "off" };
+
+    const auto seconds = static_cast<std::time_t>(record.timestamp / 1'000'000'000);
+    const auto millis = (record.timestamp / 1'000'000) % 1000;
+    const auto local_time = localtime_xp(seconds);
+
+    const char* level = record.level < static_cast<int>(std::size(LEVEL_NAMES)) ? LEVEL_NAMES[record.level] : "?";
+    const char* kind = record.kind == RecordKind::Trace ? " [trace event]" : "";
+
+    return fmt::format("[{:02}:{:02}:{:02}.{:03}] [{}] [{}]{} {}",
+        local_time.tm_hour, local_time.tm_min, local_time.tm_sec, millis, level, record.thread_id, kind, record.text);
+}
+}
+
+/*------------------------------------------------------------------*/
+// doctest:
+
+#include <doctest/doctest.h>
+
+TEST_CASE("testing flight recorder ring")
+{
+    const auto path = (std::filesystem::temp_directory_path() / "rcl_flight_recorder_test.bin").string();
+    {
+        flight_recorder::FlightRecorder recorder { path, 4 };
+        for (int i = 0; i < 6; ++i)
+            recorder.record(flight_recorder::RecordKind::Log, 2, fmt::format("message {}", i), i * 1'000'000'000ll, 1);
+    }
+
+    // Only the 4 newest records survive, oldest first:
+    auto records = flight_recorder::read_records(path);
+    REQUIRE(records.size() == 4);
+    CHECK(records.front().text == "message 2");
+    CHECK(records.back().text == "message 5");
+
+    records = flight_recorder::read_records(path, 1.5);
+    REQUIRE(records.size() == 2);
+    CHECK(records.front().text == "message 4");
+
+    std::filesystem::remove(path);
+}
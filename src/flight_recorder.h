@@ -0,0 +1,102 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <spdlog/sinks/sink.h>
+
+/*------------------------------------------------------------------*/
+// Flight recorder:
+// A fixed-size ring of records in a memory mapped file. Writing a record is a few stores into shared memory (no syscalls, no locks), and since the pages belong to the file, the kernel keeps them even if the process dies. After a crash, the last records can be dumped with rcl-flight-dump (see: src/tools/flight_dump.cpp).
+
+namespace flight_recorder
+{
+constexpr char     MAGIC[8]     = { 'R', 'C', 'L', 'F', 'L', 'I', 'G', 'H' };
+constexpr uint32_t VERSION      = 1;
+constexpr size_t   TEXT_SIZE    = 232;
+
+enum class RecordKind : uint8_t
+{
+    Log,
+    Trace,
+};
+
+struct FileHeader
+{
+    char        magic[8];
+    uint32_t    version;
+    uint32_t    record_size;
+    uint64_t    record_count;
+    uint64_t    next_sequence; // Accessed atomically.
+};
+
+struct Record
+{
+    uint64_t    sequence;   // Accessed atomically. 0 while the record is being written; otherwise its (1-based) position in the ring's history.
+    int64_t     timestamp;  // Nanoseconds since epoch, system clock.
+    uint32_t    thread_id;
+    RecordKind  kind;
+    uint8_t     level;      // spdlog::level::level_enum
+    uint16_t    length;
+    char        text[TEXT_SIZE];
+};
+static_assert(sizeof(Record) == 256);
+
+/*------------------------------------------------------------------*/
+// Writing:
+
+class FlightRecorder
+{
+public:
+    // Creates (or truncates) the file and maps it. Throws on failure.
+    FlightRecorder(const std::string& path, const uint64_t record_count);
+    ~FlightRecorder(); // Unmaps; the records stay in the file.
+
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    // Thread-safe and lock-free. Text longer than TEXT_SIZE is truncated.
+    void record(const RecordKind kind, const int level, const std::string_view text, const int64_t timestamp, const uint32_t thread_id) noexcept;
+    void record(const RecordKind kind, const int level, const std::string_view text) noexcept;
+
+    const std::string& get_path() const { return path; }
+
+private:
+    std::string path;
+    void*       mapping     = nullptr;
+    size_t      mapping_size = 0;
+    FileHeader* header      = nullptr;
+    Record*     records     = nullptr;
+
+#if defined(_WIN32)
+    void*       file_handle     = nullptr;
+    void*       mapping_handle  = nullptr;
+#else
+    int         file_descriptor = -1;
+#endif
+};
+
+// A sink which copies every log message into the flight recorder.
+std::shared_ptr<spdlog::sinks::sink> create_flight_recorder_sink(std::shared_ptr<FlightRecorder> recorder);
+
+/*------------------------------------------------------------------*/
+// Reading:
+
+struct DecodedRecord
+{
+    uint64_t    sequence;
+    int64_t     timestamp;
+    uint32_t    thread_id;
+    RecordKind  kind;
+    int         level;
+    std::string text;
+};
+
+// Returns all complete records ordered from oldest to newest. If last_seconds > 0, only records written within that many seconds of the newest record are returned. Throws if the file is not a flight recorder file.
+std::vector<DecodedRecord> read_records(const std::string& path, const double last_seconds = 0.0);
+
+// "[hh:mm:ss.mmm] [level] [thread] text"
+std::string format_record(const DecodedRecord& record);
+}
@@ -0,0 +1,71 @@
+#include "frame_pacer.h"
+
+#include <cmath>
+#include <thread>
+
+#include "log.h"
+#include "profiler.h"
+
+const double PRESENT_SMOOTHING = 1.0 / 32.0; // Weight of the latest interval in the moving averages.
+
+void FramePacer::wait(const double fps)
+{
+    const auto now = Clock::now();
+    if (!(fps > 0.0))
+    {
+        deadline = now;
+        return;
+    }
+
+    PROFILE_SCOPE("frame pacer");
+
+    deadline += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double> { 1.0 / fps });
+    if (deadline < now)
+    {
+        deadline = now;
+        return;
+    }
+
+    if (deadline - now > SPIN_THRESHOLD)
+        std::this_thread::sleep_until(deadline - SPIN_THRESHOLD);
+
+    while (Clock::now() < deadline)
+        std::this_thread::yield();
+}
+
+void FramePacer::on_present()
+{
+    const auto now = Clock::now();
+    if (last_present != Clock::time_point {})
+    {
+        const double interval_ms = std::chrono::duration<double, std::milli>(now - last_present).count();
+        if (present_interval_ms == 0.0)
+            present_interval_ms = interval_ms;
+
+        present_jitter_ms   += (std::abs(interval_ms - present_interval_ms) - present_jitter_ms) * PRESENT_SMOOTHING;
+        present_interval_ms += (interval_ms - present_interval_ms) * PRESENT_SMOOTHING;
+
+        LOG_DEBUG_EVERY_MS(5000, "present interval: {:.3f} ms (jitter: {:.3f} ms)", present_interval_ms, present_jitter_ms);
+    }
+    last_present = now;
+}
+
+/*------------------------------------------------------------------*/
+// doctest:
+
+#include <doctest/doctest.h>
+
+TEST_CASE("testing frame pacer")
+{
+    FramePacer pacer;
+    pacer.wait(0.0); // Starts the schedule.
+
+    const auto start = FramePacer::Clock::now();
+    for (int i = 0; i != 5; ++i)
+    {
+        pacer.wait(200.0);
+        pacer.on_present();
+    }
+    CHECK(FramePacer::Clock::now() - start >= std::chrono::milliseconds { 20 });
+    CHECK(pacer.get_present_interval_ms() > 4.0);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <chrono>
+
+/*------------------------------------------------------------------*/
+// FramePacer:
+// Caps the frame rate and measures how evenly frames reach the display.
+// wait() blocks until the next frame's deadline. Deadlines advance by whole periods, so that the rate does not drift with the wake-up overshoot; a frame that runs late restarts the schedule instead of being followed by a burst. The bulk of the wait is slept, the last SPIN_THRESHOLD is spin-waited, since OS sleeps overshoot by up to a scheduler quantum.
+// on_present() tracks present-to-present intervals (as seen by the CPU, i.e. when the present call returns); they are exported by the metrics exporter.
+// Called right before sampling input, wait() also keeps the input of a frame as fresh as possible:
+//   pacer.wait(fps);
+//   sample_input();
+//   render_and_present();
+//   pacer.on_present();
+
+class FramePacer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr Clock::duration SPIN_THRESHOLD = std::chrono::microseconds { 1500 };
+
+    // Blocks until one period (1 / fps) after the previous frame. fps <= 0 does not limit.
+    void wait(const double fps);
+
+    void on_present();
+
+    // Exponential moving averages over roughly the last 32 frames, in milliseconds:
+    double get_present_interval_ms() const { return present_interval_ms; }
+    double get_present_jitter_ms() const { return present_jitter_ms; } // Mean absolute deviation of the interval.
+
+private:
+    Clock::time_point deadline {};
+
+    Clock::time_point last_present {};
+    double            present_interval_ms = 0.0;
+    double            present_jitter_ms = 0.0;
+};
@@ -0,0 +1,156 @@
+#include "input_recording.h"
+
+#include <cstring>
+#include <iterator>
+
+#include "error.h"
+
+namespace input_recording
+{
+/*------------------------------------------------------------------*/
+// Recording:
+
+InputRecorder::InputRecorder(const std::string& filename) :
+    ofstr(filename, std::ios::binary | std::ios::trunc)
+{
+    if (!ofstr)
+        THROW_ERROR("input recording could not be created: {}", filename);
+
+    FileHeader header {
+        .version    = VERSION,
+        .reserved   = 0,
+    };
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    write(header);
+}
+
+template<typename T>
+void InputRecorder::write(const T& value)
+{
+    ofstr.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void InputRecorder::record_frame(const FrameInput& frame)
+{
+    if (frame.keys != keys)
+    {
+        write(EventType::Keys);
+        write(frame.keys);
+        keys = frame.keys;
+    }
+
+    for (const auto& resize : frame.resizes)
+    {
+        write(EventType::Resize);
+        write(resize);
+    }
+
+    write(EventType::Frame);
+    write(frame.elapsed_time);
+    ++frame_count;
+
+    // A single failed write would desynchronize the rest of the recording:
+    if (!ofstr)
+        THROW_ERROR("input recording could not be written (frame {})", frame_count);
+}
+
+/*------------------------------------------------------------------*/
+// Replaying:
+
+InputReplayer::InputReplayer(const std::string& filename)
+{
+    std::ifstream ifstr { filename, std::ios::binary };
+    if (!ifstr)
+        THROW_ERROR("input recording could not be opened: {}", filename);
+
+    const std::vector<char> data { std::istreambuf_iterator<char>(ifstr), std::istreambuf_iterator<char>() };
+
+    size_t offset = 0;
+    auto read = [&]<typename T>(T& value)
+    {
+        if (offset + sizeof(T) > data.size())
+            THROW_ERROR("input recording is truncated: {} (offset {})", filename, offset);
+        std::memcpy(&value, data.data() + offset, sizeof(T));
+        offset += sizeof(T);
+    };
+
+    FileHeader header;
+    read(header);
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION)
+        THROW_ERROR("not an input recording (or an unsupported version): {}", filename);
+
+    FrameInput frame;
+    while (offset != data.size())
+    {
+        EventType type;
+        read(type);
+        switch (type)
+        {
+        case EventType::Keys:
+            read(frame.keys);
+            break;
+        case EventType::Resize:
+            read(frame.resizes.emplace_back());
+            break;
+        case EventType::Frame:
+            read(frame.elapsed_time);
+            frames.push_back(frame);
+            frame.resizes.clear(); // Key states persist until the next Keys event.
+            break;
+        default:
+            THROW_ERROR("input recording has an invalid event type {}: {} (offset {})", static_cast<int>(type), filename, offset - 1);
+        }
+    }
+}
+
+bool InputReplayer::next_frame(FrameInput& frame)
+{
+    if (next == frames.size())
+        return false;
+
+    frame = frames[next++];
+    return true;
+}
+}
+
+/*------------------------------------------------------------------*/
+// doctest:
+
+#include <filesystem>
+
+#include <doctest/doctest.h>
+
+TEST_CASE("testing input recording round trip")
+{
+    using namespace input_recording;
+
+    const auto path = (std::filesystem::temp_directory_path() / "rcl_input_recording_test.rclinput").string();
+    {
+        InputRecorder recorder { path };
+        recorder.record_frame(FrameInput { .elapsed_time = 0.0016f });
+        recorder.record_frame(FrameInput { .elapsed_time = 0.0017f, .keys = static_cast<uint32_t>(Key::F12), .resizes = { { 640, 480 }, { 800, 600 } } });
+        recorder.record_frame(FrameInput { .elapsed_time = 0.0018f, .keys = static_cast<uint32_t>(Key::F12) });
+    }
+
+    InputReplayer replayer { path };
+    REQUIRE(replayer.get_frame_count() == 3);
+
+    FrameInput frame;
+    REQUIRE(replayer.next_frame(frame));
+    CHECK(frame.elapsed_time == 0.0016f);
+    CHECK(frame.keys == 0);
+
+    REQUIRE(replayer.next_frame(frame));
+    CHECK(frame.is_down(Key::F12));
+    REQUIRE(frame.resizes.size() == 2);
+    CHECK(frame.resizes[1].width == 800);
+
+    REQUIRE(replayer.next_frame(frame));
+    CHECK(frame.elapsed_time == 0.0018f);
+    CHECK(frame.is_down(Key::F12));
+    CHECK(frame.resizes.empty());
+
+    CHECK(!replayer.next_frame(frame));
+
+    std::filesystem::remove(path);
+}
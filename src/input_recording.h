@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/*------------------------------------------------------------------*/
+// Input recording:
+// Captures everything the main loop samples per frame (key states, window resizes and elapsed_time) to a compact binary file, so that a session can be replayed frame by frame without wall-clock or OS input, e.g. for profiling exactly the same session before and after a change:
+//   red-corner-lounge --record session.rclinput
+//   red-corner-lounge --replay session.rclinput [--headless]
+//
+// File: FileHeader, then a stream of events, each a one byte EventType followed by its payload:
+//   Keys:   uint32_t key mask (only written when the mask changes)
+//   Resize: int32_t width, int32_t height
+//   Frame:  float elapsed_time (ends the frame; decaseconds, see: App::main_loop)
+// Values are stored in native byte order (all supported platforms are little-endian).
+
+namespace input_recording
+{
+constexpr char     MAGIC[8] = { 'R', 'C', 'L', 'I', 'N', 'P', 'U', 'T' };
+constexpr uint32_t VERSION  = 1;
+
+struct FileHeader
+{
+    char        magic[8];
+    uint32_t    version;
+    uint32_t    reserved;
+};
+
+enum class EventType : uint8_t
+{
+    Frame   = 0,
+    Keys    = 1,
+    Resize  = 2,
+};
+
+// Keys sampled by the main loop; bits of FrameInput::keys.
+enum class Key : uint32_t
+{
+    Escape  = 1u << 0,
+    F12     = 1u << 1,
+};
+
+struct Resize
+{
+    int32_t width;
+    int32_t height;
+};
+
+struct FrameInput
+{
+    float               elapsed_time = 0.f; // In decaseconds.
+    uint32_t            keys = 0;
+    std::vector<Resize> resizes; // In order of occurrence, before the frame.
+
+    bool is_down(const Key key) const { return (keys & static_cast<uint32_t>(key)) != 0; }
+};
+
+/*------------------------------------------------------------------*/
+// Recording:
+
+class InputRecorder
+{
+public:
+    explicit InputRecorder(const std::string& filename); // Creates (or truncates) the file. Throws on failure.
+
+    void record_frame(const FrameInput& frame);
+
+    uint64_t get_frame_count() const { return frame_count; }
+
+private:
+    template<typename T>
+    void write(const T& value);
+
+    std::ofstream   ofstr;
+    uint32_t        keys = 0;
+    uint64_t        frame_count = 0;
+};
+
+/*------------------------------------------------------------------*/
+// Replaying:
+
+class InputReplayer
+{
+public:
+    explicit InputReplayer(const std::string& filename); // Reads the whole file. Throws if it cannot be read or is malformed.
+
+    // Returns false after the last recorded frame.
+    bool next_frame(FrameInput& frame);
+
+    size_t get_frame_count() const { return frames.size(); }
+
+private:
+    std::vector<FrameInput> frames;
+    size_t                  next = 0;
+};
+}
@@ -1,15 +1,27 @@
 #include "log.h"
 
+#include <spdlog/async.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/details/fmt_helper.h>
 #include <spdlog/details/os.h>
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <csignal>
 #include <filesystem>
 #include <map>
 #include <fstream>
+#include <iterator>
 
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "flight_recorder.h"
 #include "utility.h"
 
 namespace fs = std::filesystem;
@@ -18,7 +30,19 @@ namespace fs = std::filesystem;
 // Constants:
 
 const std::string LOGS_DIR = "logs";
-const int MAX_LOGS = 10;
+const int MAX_LOGS = 20; // A log and a flight recorder file per run.
+
+const auto FLUSH_INTERVAL = std::chrono::seconds(1);
+
+// 16384 * 256 B = 4 MiB; typically the last several minutes of logging:
+const uint64_t FLIGHT_RECORDER_RECORD_COUNT = 16384;
+
+const int CRASH_SIGNALS[] = { SIGSEGV, SIGABRT, SIGFPE, SIGILL, SIGTERM };
+
+/*------------------------------------------------------------------*/
+
+std::shared_ptr<flight_recorder::FlightRecorder> recorder;
+std::shared_ptr<spdlog::sinks::sink> flight_recorder_sink; // Not among the asynchronous logger's sinks; see: FlightRecordingLogger.
 
 /*------------------------------------------------------------------*/
 
@@ -134,7 +158,10 @@ public:
         if (!msg.source.empty())
         {
             dest.push_back('[');
-            const char* filename = std::strrchr(msg.source.filename, details::os::folder_sep) + 1;
+            // Either separator may appear in __FILE__, regardless of platform (and older spdlog versions lack os::folder_seps):
+            const std::string_view path = msg.source.filename;
+            const auto separator = path.find_last_of("/\\");
+            const auto filename = separator == std::string_view::npos ? path : path.substr(separator + 1);
             details::fmt_helper::append_string_view(filename, dest);
             dest.push_back(':');
             details::fmt_helper::append_int(msg.source.line, dest);
@@ -161,14 +188,15 @@ private:
 };
 }
 
-// Returns a sink to a file. File will be placed in LOGS_DIR and named using system time.
-// Returns an empty pointer if no sink could be opened.
-auto open_file_sink()
+std::unique_ptr<spdlog::formatter> create_log_formatter()
 {
-    std::shared_ptr<spdlog::sinks::basic_file_sink_mt> file_sink;
+    return std::make_unique<spdlog::DefaultFormatter>();
+}
 
-    // Try to open a sink using system time as filename:
-    try
+// Returns system time formatted for use in a filename.
+std::string get_log_timestamp()
+{
+    static const std::string timestamp = []
     {
         const auto time = std::time(nullptr);
         const auto local_time = localtime_xp(time);
@@ -176,9 +204,22 @@ auto open_file_sink()
         std::string timestamp = { buf, std::strftime(buf, sizeof(buf), "%F_%T", &local_time) };
         std::replace(timestamp.begin(), timestamp.end(), ':', '_');
         std::replace(timestamp.begin(), timestamp.end(), '-', '_');
+        return timestamp;
+    }();
+    return timestamp;
+}
 
+// Returns a sink to a file. File will be placed in LOGS_DIR and named using system time.
+// Returns an empty pointer if no sink could be opened.
+auto open_file_sink()
+{
+    std::shared_ptr<spdlog::sinks::basic_file_sink_mt> file_sink;
+
+    // Try to open a sink using system time as filename:
+    try
+    {
         std::filesystem::path path = LOGS_DIR;
-        path /= timestamp + ".txt";
+        path /= get_log_timestamp() + ".txt";
 
         const auto path_str = path.string();
         file_sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(path_str, true);
@@ -215,24 +256,185 @@ auto open_file_sink()
     return file_sink;
 }
 
+// Returns a sink to a flight recorder file next to the log file. Returns an empty pointer if the recorder could not be created.
+std::shared_ptr<spdlog::sinks::sink> open_flight_recorder_sink()
+{
+    try
+    {
+        std::filesystem::create_directories(LOGS_DIR);
+        std::filesystem::path path = LOGS_DIR;
+        path /= get_log_timestamp() + ".flight";
+
+        recorder = std::make_shared<flight_recorder::FlightRecorder>(path.string(), FLIGHT_RECORDER_RECORD_COUNT);
+        LOG_INFO("flight recorder opened; recent log will survive crashes in '{}'", recorder->get_path());
+        return flight_recorder::create_flight_recorder_sink(recorder);
+    }
+    catch (const std::exception& e)
+    {
+        LOG_ERROR("flight recorder could not be opened; exception: {}", e.what());
+        return {};
+    }
+}
+
+// Writes text to stderr with a single unbuffered system call; async-signal-safe.
+void write_to_stderr(const std::string_view text)
+{
+#if defined(_WIN32)
+    [[maybe_unused]] const int written = _write(2, text.data(), static_cast<unsigned int>(text.size()));
+#else
+    [[maybe_unused]] const ssize_t written = write(STDERR_FILENO, text.data(), text.size());
+#endif
+}
+
+// Only does async-signal-safe work: formatting, allocating and the logger's locks are off limits, so queued messages which have not been written yet are lost. The flight recorder needs no flush (its mapping is written back by the OS), so recording the signal there and reporting it on stderr are all that is done before the signal is re-raised with its default disposition.
+void on_crash_signal(int signal)
+{
+    static std::atomic_flag handling = ATOMIC_FLAG_INIT;
+    if (!handling.test_and_set())
+    {
+        // "terminating on signal " followed by the decimal signal number:
+        char message[48] = "terminating on signal ";
+        size_t length = std::char_traits<char>::length(message);
+        char digits[12];
+        size_t digit_count = 0;
+        unsigned int value = static_cast<unsigned int>(signal);
+        do
+        {
+            digits[digit_count++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        }
+        while (value != 0 && digit_count < sizeof(digits));
+        while (digit_count != 0)
+            message[length++] = digits[--digit_count];
+
+        if (recorder)
+            recorder->record(flight_recorder::RecordKind::Log, spdlog::level::critical, { message, length });
+
+        message[length++] = '\n';
+        write_to_stderr({ message, length });
+    }
+
+    std::signal(signal, SIG_DFL);
+    std::raise(signal);
+}
+
 void init_logger()
 {
     remove_old_logs();
 
+    for (const int signal : CRASH_SIGNALS)
+        std::signal(signal, on_crash_signal);
+
+    // Sinks accept every level; the logger's level is the only runtime filter:
     auto default_logger = std::make_shared<spdlog::logger>("default");
-    default_logger->set_level(spdlog::level::trace);
+    default_logger->set_level(static_cast<spdlog::level::level_enum>(SPDLOG_ACTIVE_LEVEL));
     spdlog::set_default_logger(default_logger);
 
     auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
-    console_sink->set_level(spdlog::level::trace);
-    console_sink->set_formatter(std::make_unique<spdlog::DefaultFormatter>());
+    console_sink->set_formatter(create_log_formatter());
     default_logger->sinks().push_back(console_sink);
 
     auto file_sink = open_file_sink();
     if (file_sink)
     {
-        file_sink->set_level(spdlog::level::trace);
-        file_sink->set_formatter(std::make_unique<spdlog::DefaultFormatter>());
+        file_sink->set_formatter(create_log_formatter());
         default_logger->sinks().push_back(file_sink);
     }
-}
\ No newline at end of file
+
+    // Opened after the file sink, so that its log directory exists:
+    flight_recorder_sink = open_flight_recorder_sink();
+    if (flight_recorder_sink)
+    {
+        default_logger->sinks().push_back(flight_recorder_sink);
+    }
+}
+
+void record_trace_event(const std::string_view text)
+{
+    if (recorder)
+        recorder->record(flight_recorder::RecordKind::Trace, spdlog::level::trace, text);
+}
+
+// The default logger once logging is asynchronous: writes each message into the flight recorder on the calling thread, and only then hands it to the asynchronous logger for all other sinks. A message still queued when the process crashes thus still survives in the flight recorder.
+// (spdlog::async_logger is final, so it is wrapped instead of extended.)
+class FlightRecordingLogger final : public spdlog::logger
+{
+public:
+    FlightRecordingLogger(std::shared_ptr<spdlog::sinks::sink> flight_recorder_sink, std::shared_ptr<spdlog::logger> async_logger) :
+        spdlog::logger { async_logger->name(), std::move(flight_recorder_sink) },
+        async_logger { std::move(async_logger) }
+    {}
+
+protected:
+    void sink_it_(const spdlog::details::log_msg& msg) override
+    {
+        // Only level filtering has happened so far; the flight recorder sink copies the payload without formatting:
+        for (auto& sink : sinks_)
+            sink->log(msg);
+        async_logger->log(msg.time, msg.source, msg.level, msg.payload);
+    }
+
+    void flush_() override
+    {
+        async_logger->flush();
+    }
+
+private:
+    std::shared_ptr<spdlog::logger> async_logger;
+};
+
+void init_async_logger(const size_t queue_size, const LogOverflowPolicy overflow_policy)
+{
+    auto sync_logger = spdlog::default_logger();
+
+    // The flight recorder is written synchronously (see: FlightRecordingLogger); all other sinks by the worker thread:
+    std::vector<spdlog::sink_ptr> sinks;
+    std::copy_if(sync_logger->sinks().begin(), sync_logger->sinks().end(), std::back_inserter(sinks),
+        [](const auto& sink) { return sink != flight_recorder_sink; });
+
+    const auto spdlog_policy = overflow_policy == LogOverflowPolicy::Block ?
+        spdlog::async_overflow_policy::block :
+        spdlog::async_overflow_policy::overrun_oldest;
+
+    // A single worker thread keeps messages ordered:
+    spdlog::init_thread_pool(queue_size, 1);
+
+    auto async_logger = std::make_shared<spdlog::async_logger>(
+        sync_logger->name(), sinks.begin(), sinks.end(), spdlog::thread_pool(), spdlog_policy);
+    // Messages are filtered by the default logger, before they are queued:
+    async_logger->set_level(spdlog::level::trace);
+    async_logger->flush_on(spdlog::level::err);
+
+    if (flight_recorder_sink)
+    {
+        auto default_logger = std::make_shared<FlightRecordingLogger>(flight_recorder_sink, async_logger);
+        default_logger->set_level(sync_logger->level());
+        spdlog::set_default_logger(default_logger);
+    }
+    else
+    {
+        async_logger->set_level(sync_logger->level());
+        spdlog::set_default_logger(async_logger);
+    }
+
+    // Errors are flushed immediately; everything else at least every FLUSH_INTERVAL:
+    spdlog::flush_every(FLUSH_INTERVAL);
+
+    LOG_INFO("asynchronous logging enabled; queue size: {}, overflow policy: {}",
+        queue_size, overflow_policy == LogOverflowPolicy::Block ? "block" : "drop oldest");
+}
+
+void set_log_level(const spdlog::level::level_enum level)
+{
+    if (level < SPDLOG_ACTIVE_LEVEL)
+        LOG_WARNING("log level '{}' is below the compile-time level '{}'; those messages are compiled out",
+            spdlog::level::to_string_view(level), spdlog::level::to_string_view(static_cast<spdlog::level::level_enum>(SPDLOG_ACTIVE_LEVEL)));
+
+    spdlog::default_logger_raw()->set_level(level);
+}
+
+void shutdown_logger()
+{
+    // Flushes and drops all loggers, then joins the worker thread once its queue is drained:
+    spdlog::shutdown();
+}
@@ -1,15 +1,83 @@
 #pragma once
 
 #include <spdlog/spdlog.h>
+#include <spdlog/formatter.h>
+
+#include <atomic>
+#include <chrono>
+#include <string_view>
 
 /*------------------------------------------------------------------*/
 // Macros:
+// Calls below SPDLOG_ACTIVE_LEVEL (set per build configuration in CMakeLists.txt) compile to nothing; their arguments are not evaluated.
+// Calls at or above it are filtered at runtime by the level set with set_log_level().
+//
+// The _EVERY_N(n, ...) variants log the 1st, (n+1)th, (2n+1)th... call of the call site.
+// The _EVERY_MS(ms, ...) variants log at most once per ms milliseconds per call site.
+// Both are meant for per-frame call sites.
+
+namespace log_detail
+{
+// Returns true for every n-th call with the same counter, starting with the first.
+inline bool every_n(std::atomic<uint64_t>& counter, const uint64_t n)
+{
+    return counter.fetch_add(1, std::memory_order_relaxed) % n == 0;
+}
+
+// Returns true if at least interval_ms have passed since the last call which returned true.
+inline bool every_ms(std::atomic<int64_t>& last_ms, const int64_t interval_ms)
+{
+    const int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t last = last_ms.load(std::memory_order_relaxed);
+    return (last == 0 || now_ms - last >= interval_ms) &&
+        last_ms.compare_exchange_strong(last, now_ms, std::memory_order_relaxed);
+}
+}
+
+#define LOG_EVERY_N_(LOG, n, ...) \
+    do { static std::atomic<uint64_t> log_counter_ { 0 }; if (log_detail::every_n(log_counter_, (n))) LOG(__VA_ARGS__); } while (0)
+#define LOG_EVERY_MS_(LOG, ms, ...) \
+    do { static std::atomic<int64_t> log_last_ms_ { 0 }; if (log_detail::every_ms(log_last_ms_, (ms))) LOG(__VA_ARGS__); } while (0)
+#define LOG_DISABLED_(...) (void)0
+
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
+#define LOG_TRACE(...)                  spdlog::trace(__VA_ARGS__)
+#define LOG_TRACE_EVERY_N(n, ...)       LOG_EVERY_N_(LOG_TRACE, n, __VA_ARGS__)
+#define LOG_TRACE_EVERY_MS(ms, ...)     LOG_EVERY_MS_(LOG_TRACE, ms, __VA_ARGS__)
+#else
+#define LOG_TRACE                       LOG_DISABLED_
+#define LOG_TRACE_EVERY_N               LOG_DISABLED_
+#define LOG_TRACE_EVERY_MS              LOG_DISABLED_
+#endif
+
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
+#define LOG_DEBUG(...)                  spdlog::debug(__VA_ARGS__)
+#define LOG_DEBUG_EVERY_N(n, ...)       LOG_EVERY_N_(LOG_DEBUG, n, __VA_ARGS__)
+#define LOG_DEBUG_EVERY_MS(ms, ...)     LOG_EVERY_MS_(LOG_DEBUG, ms, __VA_ARGS__)
+#else
+#define LOG_DEBUG                       LOG_DISABLED_
+#define LOG_DEBUG_EVERY_N               LOG_DISABLED_
+#define LOG_DEBUG_EVERY_MS              LOG_DISABLED_
+#endif
+
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_INFO
+#define LOG_INFO(...)                   spdlog::info(__VA_ARGS__)
+#define LOG_INFO_EVERY_N(n, ...)        LOG_EVERY_N_(LOG_INFO, n, __VA_ARGS__)
+#define LOG_INFO_EVERY_MS(ms, ...)      LOG_EVERY_MS_(LOG_INFO, ms, __VA_ARGS__)
+#else
+#define LOG_INFO                        LOG_DISABLED_
+#define LOG_INFO_EVERY_N                LOG_DISABLED_
+#define LOG_INFO_EVERY_MS               LOG_DISABLED_
+#endif
 
-#define LOG_TRACE       spdlog::trace
-#define LOG_DEBUG       spdlog::debug
-#define LOG_INFO        spdlog::info
-#define LOG_WARNING     SPDLOG_WARN
-#define LOG_ERROR       SPDLOG_ERROR
+// Warnings and errors are never stripped:
+#define LOG_WARNING(...)                SPDLOG_LOGGER_CALL(spdlog::default_logger_raw(), spdlog::level::warn, __VA_ARGS__)
+#define LOG_WARNING_EVERY_N(n, ...)     LOG_EVERY_N_(LOG_WARNING, n, __VA_ARGS__)
+#define LOG_WARNING_EVERY_MS(ms, ...)   LOG_EVERY_MS_(LOG_WARNING, ms, __VA_ARGS__)
+#define LOG_ERROR(...)                  SPDLOG_LOGGER_CALL(spdlog::default_logger_raw(), spdlog::level::err, __VA_ARGS__)
+#define LOG_ERROR_EVERY_N(n, ...)       LOG_EVERY_N_(LOG_ERROR, n, __VA_ARGS__)
+#define LOG_ERROR_EVERY_MS(ms, ...)     LOG_EVERY_MS_(LOG_ERROR, ms, __VA_ARGS__)
 
 #define LOG_WARNING_WITHOUT_SOURCE_LOCATION spdlog::warn
 #define LOG_ERROR_WITHOUT_SOURCE_LOCATION spdlog::error
@@ -17,5 +85,28 @@
 /*------------------------------------------------------------------*/
 // Logger initialization:
 
-// Directs spdlog to log to both the console and an automatically generated file.
-void init_logger();
\ No newline at end of file
+enum class LogOverflowPolicy
+{
+    Block,      // Callers wait for free space in the queue; no messages are lost.
+    DropOldest, // The oldest queued message is overwritten; callers never wait.
+};
+
+// Directs spdlog to log to the console, an automatically generated file and a crash-surviving flight recorder file (see: flight_recorder.h). Messages are written synchronously until init_async_logger() is called.
+// The runtime level starts at SPDLOG_ACTIVE_LEVEL; see: set_log_level().
+// Also installs crash signal handlers which record the signal in the flight recorder and on stderr before the process terminates; messages still queued in the asynchronous logger only reach the flight recorder.
+void init_logger();
+
+// Replaces the default logger with an asynchronous one using the same sinks: calls only enqueue the message into a bounded queue, and a background thread formats and writes it. The flight recorder is the exception; it is still written by the calling thread, so that it holds every message up to a crash.
+void init_async_logger(const size_t queue_size, const LogOverflowPolicy overflow_policy);
+
+// Sets the runtime level of the default logger; messages below it are discarded before formatting. Levels below SPDLOG_ACTIVE_LEVEL stay compiled out regardless.
+void set_log_level(const spdlog::level::level_enum level);
+
+// Flushes all queued messages and stops the background thread. Safe to call more than once.
+void shutdown_logger();
+
+// Returns the formatter used by the console and file sinks: [time] [level] [file:line] message
+std::unique_ptr<spdlog::formatter> create_log_formatter();
+
+// Writes a trace event directly into the flight recorder, bypassing the log queue. Lock-free; does nothing if the flight recorder could not be opened.
+void record_trace_event(const std::string_view text);
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <doctest/doctest.h>
 
 #include "log.h"
+#include "binlog.h"
 #include "app.h"
 
 #if defined(_MSC_VER)
@@ -36,9 +37,12 @@ int main(int argc, char** argv)
     try
     {
         init_logger();
+        binlog::start();
+
+        const auto options = parse_launch_options(argc, argv);
 
         App app;
-        exit_code = app.run();
+        exit_code = app.run(options);
     }
     catch (const std::exception& e)
     {
@@ -46,5 +50,8 @@ int main(int argc, char** argv)
         exit_code = EXIT_FAILURE;
     }
 
+    binlog::stop();
+    shutdown_logger();
+
     return exit_code;
 }
\ No newline at end of file
@@ -0,0 +1,365 @@
+#include "metrics_exporter.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+
+#if defined(__unix__)
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "log.h"
+#include "error.h"
+
+/*------------------------------------------------------------------*/
+// Constants:
+
+const std::string UNIX_SOCKET_PREFIX = "unix:";
+const int ACCEPT_POLL_INTERVAL_MS = 100; // How quickly stop() is noticed.
+const int CLIENT_TIMEOUT_MS = 1000;
+
+/*------------------------------------------------------------------*/
+// Formatting:
+
+std::string format_prometheus(const MetricsSnapshot& snapshot)
+{
+    std::string text;
+    auto out = std::back_inserter(text);
+
+    fmt::format_to(out, "# HELP rcl_frame_time_seconds CPU time between frames.\n");
+    fmt::format_to(out, "# TYPE rcl_frame_time_seconds histogram\n");
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i != MetricsSnapshot::FRAME_TIME_BUCKETS.size(); ++i)
+    {
+        cumulative += snapshot.frame_time_buckets[i];
+        fmt::format_to(out, "rcl_frame_time_seconds_bucket{{le=\"{}\"}} {}\n", MetricsSnapshot::FRAME_TIME_BUCKETS[i], cumulative);
+    }
+    cumulative += snapshot.frame_time_buckets.back();
+    fmt::format_to(out, "rcl_frame_time_seconds_bucket{{le=\"+Inf\"}} {}\n", cumulative);
+    fmt::format_to(out, "rcl_frame_time_seconds_sum {}\n", snapshot.frame_time_sum);
+    fmt::format_to(out, "rcl_frame_time_seconds_count {}\n", snapshot.frame_count);
+
+    fmt::format_to(out, "# HELP rcl_recent_frame_time_seconds CPU frame time quantiles of the most recent {} frames.\n", MetricsSnapshot::RECENT_FRAME_COUNT);
+    fmt::format_to(out, "# TYPE rcl_recent_frame_time_seconds gauge\n");
+    constexpr const char* QUANTILES[] = { "0.5", "0.95", "0.99" };
+    for (size_t i = 0; i != std::size(QUANTILES); ++i)
+        fmt::format_to(out, "rcl_recent_frame_time_seconds{{quantile=\"{}\"}} {}\n", QUANTILES[i], snapshot.frame_time_quantiles[i]);
+
+    fmt::format_to(out, "# HELP rcl_present_interval_seconds Moving average of the interval between presents, as seen by the CPU.\n");
+    fmt::format_to(out, "# TYPE rcl_present_interval_seconds gauge\n");
+    fmt::format_to(out, "rcl_present_interval_seconds {}\n", snapshot.present_interval_seconds);
+    fmt::format_to(out, "# HELP rcl_present_jitter_seconds Moving average of the absolute deviation of the present interval.\n");
+    fmt::format_to(out, "# TYPE rcl_present_jitter_seconds gauge\n");
+    fmt::format_to(out, "rcl_present_jitter_seconds {}\n", snapshot.present_jitter_seconds);
+
+    fmt::format_to(out, "# HELP rcl_gpu_region_seconds GPU time quantiles per profiled region.\n");
+    fmt::format_to(out, "# TYPE rcl_gpu_region_seconds gauge\n");
+    for (const auto& region : snapshot.gpu_regions)
+    {
+        fmt::format_to(out, "rcl_gpu_region_seconds{{region=\"{}\",quantile=\"0.5\"}} {}\n", region.name, region.p50_seconds);
+        fmt::format_to(out, "rcl_gpu_region_seconds{{region=\"{}\",quantile=\"0.95\"}} {}\n", region.name, region.p95_seconds);
+        fmt::format_to(out, "rcl_gpu_region_seconds{{region=\"{}\",quantile=\"0.99\"}} {}\n", region.name, region.p99_seconds);
+    }
+
+    for (size_t i = 0; i != vki::stats::COUNTER_COUNT; ++i)
+    {
+        const char* name = vki::stats::get_name(static_cast<vki::stats::Counter>(i));
+        fmt::format_to(out, "# TYPE rcl_renderer_{}_total counter\n", name);
+        fmt::format_to(out, "rcl_renderer_{}_total {}\n", name, snapshot.renderer_totals.values[i]);
+    }
+
+    fmt::format_to(out, "# HELP rcl_resident_memory_bytes Resident set size of the process.\n");
+    fmt::format_to(out, "# TYPE rcl_resident_memory_bytes gauge\n");
+    fmt::format_to(out, "rcl_resident_memory_bytes {}\n", snapshot.resident_memory_bytes);
+
+    return text;
+}
+
+/*------------------------------------------------------------------*/
+// Render thread:
+
+void MetricsExporter::record_frame(const double frame_seconds)
+{
+    const auto bucket = std::lower_bound(
+        MetricsSnapshot::FRAME_TIME_BUCKETS.begin(), MetricsSnapshot::FRAME_TIME_BUCKETS.end(), frame_seconds);
+    ++back.frame_time_buckets[bucket - MetricsSnapshot::FRAME_TIME_BUCKETS.begin()];
+    back.frame_time_sum += frame_seconds;
+    ++back.frame_count;
+
+    recent_frames[recent_frame_count % recent_frames.size()] = frame_seconds;
+    ++recent_frame_count;
+}
+
+void MetricsExporter::record_present_timing(const double interval_seconds, const double jitter_seconds)
+{
+    back.present_interval_seconds = interval_seconds;
+    back.present_jitter_seconds = jitter_seconds;
+}
+
+bool MetricsExporter::is_publish_due() const
+{
+    return is_running() && std::chrono::steady_clock::now() - last_publish >= PUBLISH_INTERVAL;
+}
+
+void MetricsExporter::publish(std::vector<MetricsSnapshot::GpuRegion> gpu_regions, const vki::stats::Snapshot& renderer_totals)
+{
+    const size_t count = std::min(recent_frame_count, recent_frames.size());
+    if (count > 0)
+    {
+        std::array<double, MetricsSnapshot::RECENT_FRAME_COUNT> sorted = recent_frames;
+        std::sort(sorted.begin(), sorted.begin() + count);
+        const auto quantile = [&](const double q) { return sorted[std::min(count - 1, static_cast<size_t>(q * count))]; };
+        back.frame_time_quantiles = { quantile(0.5), quantile(0.95), quantile(0.99) };
+    }
+    back.gpu_regions = std::move(gpu_regions);
+    back.renderer_totals = renderer_totals;
+
+    // Never wait for a scrape; while a scrape holds the lock, the publish stays due and is retried on the next frame:
+    std::unique_lock lock { front_mutex, std::try_to_lock };
+    if (!lock.owns_lock())
+        return;
+
+    front = back;
+    last_publish = std::chrono::steady_clock::now();
+}
+
+/*------------------------------------------------------------------*/
+// Exporter thread:
+
+// Reads a file, hence only called by the exporter thread, once per scrape.
+uint64_t get_resident_memory_bytes()
+{
+#if defined(__unix__)
+    // statm: size resident shared text lib data dt (in pages)
+    std::ifstream statm { "/proc/self/statm" };
+    uint64_t size = 0, resident = 0;
+    if (statm >> size >> resident)
+        return resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#endif
+    return 0;
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    stop();
+}
+
+#if defined(__unix__)
+
+void MetricsExporter::start(const std::string& endpoint)
+{
+    assert(!is_running());
+
+    if (endpoint.starts_with(UNIX_SOCKET_PREFIX))
+    {
+        unix_socket_path = endpoint.substr(UNIX_SOCKET_PREFIX.size());
+
+        sockaddr_un address {};
+        address.sun_family = AF_UNIX;
+        if (unix_socket_path.empty() || unix_socket_path.size() >= sizeof(address.sun_path))
+            THROW_ERROR("invalid unix socket path: '{}'", unix_socket_path);
+        std::strcpy(address.sun_path, unix_socket_path.c_str());
+
+        // A stale socket file of a previous run would make bind fail:
+        ::unlink(unix_socket_path.c_str());
+
+        listen_socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_socket < 0 || ::bind(listen_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+            THROW_ERROR("metrics socket could not be bound to '{}': {}", endpoint, std::strerror(errno));
+    }
+    else
+    {
+        const auto separator = endpoint.rfind(':');
+        if (separator == std::string::npos)
+            THROW_ERROR("invalid metrics endpoint: '{}'; expected 'unix:<path>' or '<address>:<port>'", endpoint);
+        const std::string host = endpoint.substr(0, separator);
+        const std::string_view port_string = std::string_view { endpoint }.substr(separator + 1);
+
+        int port = 0;
+        const auto [end, ec] = std::from_chars(port_string.data(), port_string.data() + port_string.size(), port);
+        if (ec != std::errc {} || end != port_string.data() + port_string.size() || port < 1 || port > 65535)
+            THROW_ERROR("invalid metrics port: '{}'; expected 1 to 65535", port_string);
+
+        // Names (e.g. "localhost") are resolved; only IPv4 addresses are used:
+        addrinfo hints {};
+        hints.ai_flags = AI_NUMERICSERV;
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* resolved = nullptr;
+        const int resolve_result = ::getaddrinfo(host.c_str(), std::string { port_string }.c_str(), &hints, &resolved);
+        if (resolve_result != 0 || !resolved)
+            THROW_ERROR("invalid metrics address: '{}': {}", host, ::gai_strerror(resolve_result));
+        sockaddr_in address {};
+        std::memcpy(&address, resolved->ai_addr, sizeof(address));
+        ::freeaddrinfo(resolved);
+
+        listen_socket = ::socket(AF_INET, SOCK_STREAM, 0);
+        const int reuse = 1;
+        if (listen_socket >= 0)
+            ::setsockopt(listen_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        if (listen_socket < 0 || ::bind(listen_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+            THROW_ERROR("metrics socket could not be bound to '{}': {}", endpoint, std::strerror(errno));
+    }
+
+    if (::listen(listen_socket, 8) != 0)
+        THROW_ERROR("metrics socket could not listen on '{}': {}", endpoint, std::strerror(errno));
+
+    running.store(true);
+    thread = std::thread { [this] { serve(); } };
+
+    LOG_INFO("serving metrics on '{}'", endpoint);
+}
+
+void MetricsExporter::stop()
+{
+    if (running.exchange(false))
+        thread.join();
+
+    if (listen_socket >= 0)
+    {
+        ::close(listen_socket);
+        listen_socket = -1;
+    }
+    if (!unix_socket_path.empty())
+    {
+        ::unlink(unix_socket_path.c_str());
+        unix_socket_path.clear();
+    }
+}
+
+void MetricsExporter::serve()
+{
+    while (running.load())
+    {
+        pollfd listen_poll { .fd = listen_socket, .events = POLLIN, .revents = 0 };
+        if (::poll(&listen_poll, 1, ACCEPT_POLL_INTERVAL_MS) <= 0)
+            continue;
+
+        const int client = ::accept(listen_socket, nullptr, nullptr);
+        if (client < 0)
+            continue;
+
+        // The request is not inspected beyond reading its header; every path serves the metrics:
+        std::string request;
+        char buffer[1024];
+        pollfd client_poll { .fd = client, .events = POLLIN, .revents = 0 };
+        while (request.find("\r\n\r\n") == std::string::npos && request.size() < 16 * 1024 &&
+               ::poll(&client_poll, 1, CLIENT_TIMEOUT_MS) > 0)
+        {
+            const auto received = ::recv(client, buffer, sizeof(buffer), 0);
+            if (received <= 0)
+                break;
+            request.append(buffer, static_cast<size_t>(received));
+        }
+
+        MetricsSnapshot snapshot;
+        {
+            std::lock_guard lock { front_mutex };
+            snapshot = front;
+        }
+        snapshot.resident_memory_bytes = get_resident_memory_bytes();
+        const std::string body = format_prometheus(snapshot);
+        const std::string response = fmt::format(
+            "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: {}\r\nConnection: close\r\n\r\n{}",
+            body.size(), body);
+
+        size_t sent = 0;
+        while (sent < response.size())
+        {
+            const auto result = ::send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+            if (result <= 0)
+                break;
+            sent += static_cast<size_t>(result);
+        }
+        ::close(client);
+    }
+}
+
+#else
+
+void MetricsExporter::start(const std::string& endpoint)
+{
+    THROW_ERROR("metrics export is not supported on this platform; endpoint: '{}'", endpoint);
+}
+
+void MetricsExporter::stop()
+{
+}
+
+void MetricsExporter::serve()
+{
+}
+
+#endif
+
+/*------------------------------------------------------------------*/
+// doctest:
+
+#include <doctest/doctest.h>
+
+TEST_CASE("testing prometheus formatting")
+{
+    MetricsSnapshot snapshot;
+    snapshot.frame_time_buckets[0] = 2;
+    snapshot.frame_time_buckets.back() = 1;
+    snapshot.frame_count = 3;
+    snapshot.present_interval_seconds = 0.016;
+    snapshot.gpu_regions.push_back({ .name = "world pass", .p50_seconds = 0.001, .p95_seconds = 0.002, .p99_seconds = 0.003 });
+
+    const auto text = format_prometheus(snapshot);
+    CHECK(text.find("rcl_frame_time_seconds_bucket{le=\"0.002\"} 2\n") != std::string::npos);
+    CHECK(text.find("rcl_frame_time_seconds_bucket{le=\"+Inf\"} 3\n") != std::string::npos);
+    CHECK(text.find("rcl_gpu_region_seconds{region=\"world pass\",quantile=\"0.99\"} 0.003\n") != std::string::npos);
+    CHECK(text.find("rcl_present_interval_seconds 0.016\n") != std::string::npos);
+    CHECK(text.find("rcl_renderer_draws_total 0\n") != std::string::npos);
+}
+
+#if defined(__unix__)
+TEST_CASE("testing metrics scrape over loopback")
+{
+    // Let the OS pick a free port:
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    {
+        const int probe = ::socket(AF_INET, SOCK_STREAM, 0);
+        socklen_t length = sizeof(address);
+        REQUIRE(::bind(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+        REQUIRE(::getsockname(probe, reinterpret_cast<sockaddr*>(&address), &length) == 0);
+        ::close(probe);
+    }
+    const int port = ntohs(address.sin_port);
+
+    CHECK_THROWS(MetricsExporter {}.start("127.0.0.1:0"));
+    CHECK_THROWS(MetricsExporter {}.start("127.0.0.1:65536"));
+    CHECK_THROWS(MetricsExporter {}.start("127.0.0.1:http"));
+
+    MetricsExporter exporter;
+    exporter.start(fmt::format("localhost:{}", port));
+    exporter.record_frame(0.010);
+    exporter.publish({}, vki::stats::Snapshot {});
+
+    const int client = ::socket(AF_INET, SOCK_STREAM, 0);
+    REQUIRE(::connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+    const std::string request = "GET /metrics HTTP/1.0\r\n\r\n";
+    REQUIRE(::send(client, request.data(), request.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(request.size()));
+
+    // The exporter closes the connection after the response:
+    std::string response;
+    char buffer[4096];
+    for (ssize_t received; (received = ::recv(client, buffer, sizeof(buffer), 0)) > 0;)
+        response.append(buffer, static_cast<size_t>(received));
+    ::close(client);
+    exporter.stop();
+
+    CHECK(response.starts_with("HTTP/1.0 200 OK\r\n"));
+    CHECK(response.find("rcl_frame_time_seconds_bucket{le=\"0.0125\"} 1\n") != std::string::npos);
+    CHECK(response.find("rcl_frame_time_seconds_count 1\n") != std::string::npos);
+}
+#endif
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "vki/vulkan_stats.h"
+
+/*------------------------------------------------------------------*/
+// Metrics exporter:
+// Serves metrics in the Prometheus text exposition format over HTTP, on a Unix domain socket ("unix:/path/to.sock") or a TCP port ("127.0.0.1:9464" or "localhost:9464"; names are resolved to IPv4 addresses).
+//   curl --unix-socket /tmp/rcl.sock http://localhost/metrics
+//   curl http://127.0.0.1:9464/metrics
+// The render thread fills a private snapshot and publishes it at most every PUBLISH_INTERVAL, using try_lock; the exporter thread formats a copy of the published snapshot. A scrape therefore never makes the render thread wait, at worst it delays a publish to the next frame.
+
+struct MetricsSnapshot
+{
+    // Upper bounds in seconds; the implicit last bucket is +Inf:
+    static constexpr std::array<double, 9> FRAME_TIME_BUCKETS { 0.002, 0.004, 0.008, 0.0125, 0.0167, 0.025, 0.0333, 0.05, 0.1 };
+    static constexpr size_t RECENT_FRAME_COUNT = 512; // Used for the frame time quantiles.
+
+    struct GpuRegion
+    {
+        std::string name;
+        double      p50_seconds;
+        double      p95_seconds;
+        double      p99_seconds;
+    };
+
+    // Cumulative since start:
+    std::array<uint64_t, FRAME_TIME_BUCKETS.size() + 1> frame_time_buckets {}; // Not cumulative between buckets; summed when formatted.
+    double      frame_time_sum = 0.0;
+    uint64_t    frame_count = 0;
+
+    std::array<double, 3>   frame_time_quantiles {}; // 0.5, 0.95, 0.99 of the most recent frames.
+    double                  present_interval_seconds = 0.0; // Moving averages (see: FramePacer).
+    double                  present_jitter_seconds = 0.0;
+    std::vector<GpuRegion>  gpu_regions;
+    vki::stats::Snapshot    renderer_totals;
+    uint64_t                resident_memory_bytes = 0; // Sampled by the exporter thread when scraped.
+};
+
+// Returns the snapshot in the Prometheus text exposition format (version 0.0.4).
+std::string format_prometheus(const MetricsSnapshot& snapshot);
+
+class MetricsExporter
+{
+public:
+    static constexpr auto PUBLISH_INTERVAL = std::chrono::milliseconds(250);
+
+    MetricsExporter() = default;
+    ~MetricsExporter(); // Stops the exporter thread.
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    // Binds the endpoint and starts the exporter thread. Throws if the endpoint cannot be bound.
+    void start(const std::string& endpoint);
+    void stop();
+    bool is_running() const { return running.load(std::memory_order_relaxed); }
+
+    // Render thread:
+    void record_frame(const double frame_seconds);
+    void record_present_timing(const double interval_seconds, const double jitter_seconds);
+    bool is_publish_due() const;
+    void publish(std::vector<MetricsSnapshot::GpuRegion> gpu_regions, const vki::stats::Snapshot& renderer_totals);
+
+private:
+    void serve();
+
+private:
+    // Render thread only:
+    MetricsSnapshot                             back;
+    std::array<double, MetricsSnapshot::RECENT_FRAME_COUNT> recent_frames {};
+    size_t                                      recent_frame_count = 0;
+    std::chrono::steady_clock::time_point       last_publish;
+
+    // Shared:
+    std::mutex                                  front_mutex;
+    MetricsSnapshot                             front;
+
+    std::thread                                 thread;
+    std::atomic<bool>                           running { false };
+    int                                         listen_socket = -1;
+    std::string                                 unix_socket_path; // Removed on stop.
+};
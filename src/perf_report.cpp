@@ -0,0 +1,124 @@
+#include "perf_report.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "error.h"
+
+namespace perf
+{
+
+const double DEFAULT_TIMING_RELATIVE_TOLERANCE = 0.25;
+const double DEFAULT_TIMING_ABSOLUTE_TOLERANCE = 0.05; // In ms; keeps very short timings from failing on jitter.
+
+nlohmann::json to_json(const Report& report)
+{
+    return nlohmann::json {
+        { "scene",          report.scene },
+        { "device",         report.device },
+        { "width",          report.width },
+        { "height",         report.height },
+        { "frame_count",    report.frame_count },
+        { "metrics",        report.metrics },
+    };
+}
+
+nlohmann::json create_baseline(const Report& report)
+{
+    nlohmann::json metrics = nlohmann::json::object();
+    for (const auto& [name, value] : report.metrics)
+    {
+        const bool timing = name.find("_ms") != std::string::npos;
+        metrics[name] = {
+            { "value",              value },
+            { "relative_tolerance", timing ? DEFAULT_TIMING_RELATIVE_TOLERANCE : 0.0 },
+            { "absolute_tolerance", timing ? DEFAULT_TIMING_ABSOLUTE_TOLERANCE : 0.0 },
+        };
+    }
+
+    return nlohmann::json {
+        { "scene",      report.scene },
+        { "device",     report.device },
+        { "metrics",    metrics },
+    };
+}
+
+std::vector<Comparison> compare_to_baseline(const Report& report, const nlohmann::json& baseline)
+{
+    if (!baseline.contains("metrics") || !baseline["metrics"].is_object())
+        THROW_ERROR("baseline has no metrics object");
+
+    std::vector<Comparison> comparisons;
+    for (const auto& [name, entry] : baseline["metrics"].items())
+    {
+        if (!entry.contains("value"))
+            THROW_ERROR("baseline metric '{}' has no value", name);
+
+        Comparison comparison {
+            .metric     = name,
+            .baseline   = entry["value"].get<double>(),
+        };
+        comparison.limit = comparison.baseline * (1.0 + entry.value("relative_tolerance", 0.0)) + entry.value("absolute_tolerance", 0.0);
+
+        const auto it = report.metrics.find(name);
+        if (it == report.metrics.end())
+        {
+            comparison.current   = std::numeric_limits<double>::quiet_NaN();
+            comparison.regressed = true;
+        }
+        else
+        {
+            comparison.current   = it->second;
+            comparison.regressed = comparison.current > comparison.limit;
+        }
+        comparisons.push_back(comparison);
+    }
+    return comparisons;
+}
+
+double get_percentile(std::vector<double> samples, const double p)
+{
+    if (samples.empty())
+        return 0.0;
+
+    const auto index = std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+}
+
+/*------------------------------------------------------------------*/
+// doctest:
+
+#include <doctest/doctest.h>
+
+TEST_CASE("testing perf baseline comparison")
+{
+    perf::Report report {
+        .scene      = "test",
+        .metrics    = { { "cpu_frame_ms_p50", 2.0 }, { "draws_per_frame", 1.0 } },
+    };
+
+    // A baseline created from the report passes against itself:
+    const auto baseline = perf::create_baseline(report);
+    for (const auto& comparison : perf::compare_to_baseline(report, baseline))
+        CHECK(!comparison.regressed);
+
+    // Timings get slack, counters do not:
+    report.metrics["cpu_frame_ms_p50"] = 2.4;
+    report.metrics["draws_per_frame"]  = 2.0;
+    const auto comparisons = perf::compare_to_baseline(report, baseline);
+    REQUIRE(comparisons.size() == 2);
+    for (const auto& comparison : comparisons)
+        CHECK(comparison.regressed == (comparison.metric == "draws_per_frame"));
+
+    // Missing metrics regress:
+    report.metrics.erase("draws_per_frame");
+    const auto missing = perf::compare_to_baseline(report, baseline);
+    CHECK(std::count_if(missing.begin(), missing.end(), [](const auto& c) { return c.regressed; }) == 1);
+
+    CHECK(perf::get_percentile({ 4.0, 1.0, 3.0, 2.0 }, 0.5) == 3.0);
+    CHECK(perf::get_percentile({}, 0.5) == 0.0);
+}
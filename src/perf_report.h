@@ -0,0 +1,48 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+/*------------------------------------------------------------------*/
+// Performance reports:
+// A report is a flat set of named metrics, all of which are "lower is better" (frame times, per-frame counters). A baseline stores a value and tolerances per metric:
+//   { "device": "llvmpipe (LLVM 15.0.7, 256 bits)", "metrics": { "cpu_frame_ms_p50": { "value": 1.8, "relative_tolerance": 0.25, "absolute_tolerance": 0.05 }, ... } }
+// A metric regresses if it exceeds value * (1 + relative_tolerance) + absolute_tolerance. Metrics without a baseline entry are not compared.
+
+namespace perf
+{
+
+struct Report
+{
+    std::string                     scene;
+    std::string                     device;
+    uint32_t                        width = 0;
+    uint32_t                        height = 0;
+    uint32_t                        frame_count = 0; // Measured frames (without warm-up).
+    std::map<std::string, double>   metrics;
+};
+
+nlohmann::json to_json(const Report& report);
+
+// Creates a baseline from a report, with default tolerances: timings ("*_ms*") get some slack for noise, counters get none.
+nlohmann::json create_baseline(const Report& report);
+
+struct Comparison
+{
+    std::string metric;
+    double      baseline = 0.0;
+    double      current  = 0.0;
+    double      limit    = 0.0;
+    bool        regressed = false;
+};
+
+// Throws if the baseline is malformed. A metric missing from the report counts as regressed.
+std::vector<Comparison> compare_to_baseline(const Report& report, const nlohmann::json& baseline);
+
+// Samples are copied; p in [0; 1]. Returns 0 for no samples.
+double get_percentile(std::vector<double> samples, const double p);
+
+}
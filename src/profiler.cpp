@@ -0,0 +1,308 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "log.h"
+#include "error.h"
+
+namespace profiler
+{
+static_assert((MAX_EVENTS_PER_THREAD & (MAX_EVENTS_PER_THREAD - 1)) == 0);
+
+/*------------------------------------------------------------------*/
+// Buffers:
+
+struct Event
+{
+    const char* name;
+    int64_t     begin;
+    int64_t     end;
+};
+
+// Single-producer (the owning thread) ring of events. Readers copy events out and discard the ones which were overwritten during the copy.
+struct ThreadBuffer
+{
+    std::unique_ptr<Event[]>    events { new Event[MAX_EVENTS_PER_THREAD] };
+    std::atomic<uint64_t>       count { 0 }; // Written by the producer.
+    uint32_t                    thread_index = 0;
+
+    std::mutex                  name_mutex;
+    std::string                 name;
+};
+
+struct State
+{
+    std::mutex                                  mutex; // Guards registration of buffers.
+    std::vector<std::shared_ptr<ThreadBuffer>>  buffers;
+
+    std::atomic<bool>                           enabled { true };
+    const int64_t                               start_timestamp = get_timestamp();
+};
+
+State& get_state()
+{
+    static State state;
+    return state;
+}
+
+ThreadBuffer& get_thread_buffer()
+{
+    // Buffers are shared with the state, so that scopes of exited threads can still be exported:
+    thread_local std::shared_ptr<ThreadBuffer> buffer = []
+    {
+        auto& state = get_state();
+        auto new_buffer = std::make_shared<ThreadBuffer>();
+
+        std::lock_guard lock { state.mutex };
+        new_buffer->thread_index = static_cast<uint32_t>(state.buffers.size());
+        new_buffer->name = fmt::format("thread {}", new_buffer->thread_index);
+        state.buffers.push_back(new_buffer);
+        return new_buffer;
+    }();
+    return *buffer;
+}
+
+/*------------------------------------------------------------------*/
+
+int64_t get_timestamp()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void push_event(ThreadBuffer& buffer, const char* name, const int64_t begin, const int64_t end)
+{
+    const uint64_t count = buffer.count.load(std::memory_order_relaxed);
+    buffer.events[count & (MAX_EVENTS_PER_THREAD - 1)] = { name, begin, end };
+    buffer.count.store(count + 1, std::memory_order_release);
+}
+
+void record(const char* name, const int64_t begin, const int64_t end)
+{
+    if (!get_state().enabled.load(std::memory_order_relaxed))
+        return;
+
+    push_event(get_thread_buffer(), name, begin, end);
+}
+
+void set_enabled(const bool enabled)
+{
+    get_state().enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool is_enabled()
+{
+    return get_state().enabled.load(std::memory_order_relaxed);
+}
+
+void set_thread_name(const std::string& name)
+{
+    auto& buffer = get_thread_buffer();
+    std::lock_guard lock { buffer.name_mutex };
+    buffer.name = name;
+}
+
+Track create_track(const std::string& name)
+{
+    auto& state = get_state();
+    auto track = std::make_shared<ThreadBuffer>();
+    track->name = name;
+
+    // The state keeps the buffer alive, so the returned pointer never dangles:
+    std::lock_guard lock { state.mutex };
+    track->thread_index = static_cast<uint32_t>(state.buffers.size());
+    state.buffers.push_back(track);
+    return track.get();
+}
+
+void record(const Track track, const char* name, const int64_t begin, const int64_t end)
+{
+    if (!get_state().enabled.load(std::memory_order_relaxed))
+        return;
+
+    assert(track);
+    push_event(*track, name, begin, end);
+}
+
+/*------------------------------------------------------------------*/
+// Export:
+
+// Returns the events currently held by a buffer, oldest first.
+std::vector<Event> copy_events(const ThreadBuffer& buffer)
+{
+    const uint64_t count = buffer.count.load(std::memory_order_acquire);
+    const uint64_t first = count > MAX_EVENTS_PER_THREAD ? count - MAX_EVENTS_PER_THREAD : 0;
+
+    std::vector<Event> events;
+    events.reserve(count - first);
+    for (uint64_t i = first; i < count; ++i)
+        events.push_back(buffer.events[i & (MAX_EVENTS_PER_THREAD - 1)]);
+
+    // Events the producer overwrote in the meantime are unreliable:
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t count_after = buffer.count.load(std::memory_order_relaxed);
+    const uint64_t first_valid = count_after > MAX_EVENTS_PER_THREAD ? count_after - MAX_EVENTS_PER_THREAD : 0;
+    if (first_valid > first)
+        events.erase(events.begin(), events.begin() + static_cast<ptrdiff_t>(std::min(first_valid - first, count - first)));
+
+    return events;
+}
+
+std::string escape_json(const std::string_view text)
+{
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (const char c : text)
+    {
+        if (c == '"' || c == '\\')
+            escaped.push_back('\\');
+        if (static_cast<unsigned char>(c) >= 0x20)
+            escaped.push_back(c);
+    }
+    return escaped;
+}
+
+void write_chrome_trace(const std::string& filename)
+{
+    auto& state = get_state();
+
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        std::lock_guard lock { state.mutex };
+        buffers = state.buffers;
+    }
+
+    std::ofstream file { filename };
+    if (!file)
+        THROW_ERROR("trace file could not be opened: {}", filename);
+
+    // Timestamps are in microseconds, relative to profiler start:
+    const auto to_us = [&](const int64_t timestamp) { return (timestamp - state.start_timestamp) * 1e-3; };
+
+    size_t event_count = 0;
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    file << R"({"name":"process_name","ph":"M","pid":1,"args":{"name":"red-corner-lounge"}})";
+    for (const auto& buffer : buffers)
+    {
+        std::string name;
+        {
+            std::lock_guard lock { buffer->name_mutex };
+            name = buffer->name;
+        }
+        file << fmt::format(",\n{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}",
+            buffer->thread_index, escape_json(name));
+
+        const auto events = copy_events(*buffer);
+        for (const auto& event : events)
+        {
+            file << fmt::format(",\n{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+                escape_json(event.name), buffer->thread_index, to_us(event.begin), (event.end - event.begin) * 1e-3);
+        }
+        event_count += events.size();
+    }
+    file << "\n]}\n";
+
+    if (!file)
+        THROW_ERROR("trace file could not be written: {}", filename);
+
+    LOG_INFO("profiler trace with {} scopes from {} threads written to '{}'", event_count, buffers.size(), filename);
+}
+}
+
+/*------------------------------------------------------------------*/
+// doctest:
+
+#include <doctest/doctest.h>
+
+#include <filesystem>
+#include <map>
+#include <thread>
+
+#include <nlohmann/json.hpp>
+
+TEST_CASE("testing profiler json escaping")
+{
+    CHECK(profiler::escape_json("VulkanRenderer::init") == "VulkanRenderer::init");
+    CHECK(profiler::escape_json("a \"b\" \\c\n") == "a \\\"b\\\" \\\\c");
+}
+
+TEST_CASE("testing profiler chrome trace export")
+{
+    const int64_t base = profiler::get_timestamp();
+    const int64_t wrap_count = 10; // Events beyond the capacity of the wrapped ring.
+
+    // One thread records a few scopes of known duration, the other one wraps its ring:
+    std::thread a { [&]
+    {
+        profiler::set_thread_name("profiler test a");
+        for (int64_t i = 0; i != 3; ++i)
+            profiler::record("test a", base + i * 10'000, base + i * 10'000 + (i + 1) * 1'000);
+    } };
+    std::thread b { [&]
+    {
+        profiler::set_thread_name("profiler test b");
+        for (int64_t i = 0; i != static_cast<int64_t>(profiler::MAX_EVENTS_PER_THREAD) + wrap_count; ++i)
+            profiler::record("test b", base + i * 1'000, base + i * 1'000 + 500);
+    } };
+    a.join();
+    b.join();
+
+    const auto track = profiler::create_track("profiler test track");
+    profiler::record(track, "test track", base, base + 4'000);
+
+    const auto path = (std::filesystem::temp_directory_path() / "rcl_profiler_test.json").string();
+    profiler::write_chrome_trace(path);
+
+    std::ifstream file { path };
+    REQUIRE(file.is_open());
+    const auto trace = nlohmann::json::parse(file);
+    file.close();
+    std::filesystem::remove(path);
+
+    std::map<std::string, int> tids;
+    std::map<int, std::vector<nlohmann::json>> events_by_tid;
+    for (const auto& event : trace["traceEvents"])
+    {
+        if (event["name"] == "thread_name")
+            tids[event["args"]["name"].get<std::string>()] = event["tid"].get<int>();
+        else if (event["ph"] == "X")
+            events_by_tid[event["tid"].get<int>()].push_back(event);
+    }
+    REQUIRE(tids.count("profiler test a") == 1);
+    REQUIRE(tids.count("profiler test b") == 1);
+    REQUIRE(tids.count("profiler test track") == 1);
+    CHECK(tids["profiler test a"] != tids["profiler test b"]);
+
+    // Timestamps are in microseconds since profiler start:
+    const auto& events_a = events_by_tid[tids["profiler test a"]];
+    REQUIRE(events_a.size() == 3);
+    const double base_us = events_a[0]["ts"].get<double>();
+    for (size_t i = 0; i != events_a.size(); ++i)
+    {
+        CHECK(events_a[i]["name"] == "test a");
+        CHECK(events_a[i]["ts"].get<double>() == doctest::Approx(base_us + i * 10.0));
+        CHECK(events_a[i]["dur"].get<double>() == doctest::Approx((i + 1) * 1.0));
+    }
+
+    // Only the newest MAX_EVENTS_PER_THREAD events of the wrapped ring are exported, oldest first:
+    const auto& events_b = events_by_tid[tids["profiler test b"]];
+    REQUIRE(events_b.size() == profiler::MAX_EVENTS_PER_THREAD);
+    CHECK(events_b.front()["ts"].get<double>() == doctest::Approx(base_us + wrap_count * 1.0));
+    CHECK(events_b.back()["ts"].get<double>() == doctest::Approx(base_us + (profiler::MAX_EVENTS_PER_THREAD + wrap_count - 1) * 1.0));
+    CHECK(events_b.front()["dur"].get<double>() == doctest::Approx(0.5));
+
+    const auto& events_track = events_by_tid[tids["profiler test track"]];
+    REQUIRE(events_track.size() == 1);
+    CHECK(events_track[0]["name"] == "test track");
+    CHECK(events_track[0]["ts"].get<double>() == doctest::Approx(base_us));
+    CHECK(events_track[0]["dur"].get<double>() == doctest::Approx(4.0));
+}
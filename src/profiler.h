@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/*------------------------------------------------------------------*/
+// CPU profiler:
+// PROFILE_SCOPE("record_world");
+// Records the begin and end timestamps of the enclosing scope into a per-thread ring buffer (lock-free; the owning thread is the only writer). The name must be a string literal, or otherwise outlive the profiler.
+// Recorded scopes are exported with write_chrome_trace(), which produces a Chrome trace JSON file (viewable in chrome://tracing or ui.perfetto.dev). Each thread keeps its most recent MAX_EVENTS_PER_THREAD scopes.
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+#define PROFILE_SCOPE(name) const ::profiler::Scope PROFILE_CONCAT(profile_scope_, __LINE__) { name }
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+
+namespace profiler
+{
+struct ThreadBuffer;
+
+constexpr size_t MAX_EVENTS_PER_THREAD = 64 * 1024; // Must be a power of two.
+
+// Nanoseconds on the steady clock.
+int64_t get_timestamp();
+
+void record(const char* name, const int64_t begin, const int64_t end);
+
+class Scope
+{
+public:
+    explicit Scope(const char* name) :
+        name { name },
+        begin { get_timestamp() }
+    {}
+
+    ~Scope()
+    {
+        record(name, begin, get_timestamp());
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* name;
+    const int64_t begin;
+};
+
+// Disabled scopes cost a timestamp and a relaxed load. Enabled by default.
+void set_enabled(const bool enabled);
+bool is_enabled();
+
+// Names the calling thread in exported traces.
+void set_thread_name(const std::string& name);
+
+// Tracks are named timelines which are not tied to a thread, e.g. for GPU work. A track must only be recorded to by one thread at a time.
+// The handle stays valid until the program exits, so recording to a track is as cheap as recording a scope (no lock).
+using Track = ThreadBuffer*;
+Track create_track(const std::string& name);
+void record(const Track track, const char* name, const int64_t begin, const int64_t end);
+
+// Writes all recorded scopes as Chrome trace JSON. May be called while other threads keep recording. Throws on failure.
+void write_chrome_trace(const std::string& filename);
+}
@@ -0,0 +1,73 @@
+#include "simulation_clock.h"
+
+#include <cmath>
+
+#include "error.h"
+
+SimulationClock::SimulationClock(const double rate, const uint32_t max_steps_per_advance) :
+    step(1.0 / rate),
+    max_steps_per_advance(max_steps_per_advance)
+{
+    if (!(rate > 0.0))
+        THROW_ERROR("simulation rate must be positive: {}", rate);
+}
+
+uint32_t SimulationClock::advance(const double elapsed_seconds)
+{
+    if (elapsed_seconds > 0.0)
+        accumulator += elapsed_seconds;
+
+    const double available = std::floor(accumulator / step);
+    uint32_t steps = available < max_steps_per_advance ? static_cast<uint32_t>(available) : max_steps_per_advance;
+    accumulator -= steps * step;
+
+    // Drop whole steps that could not be simulated, but keep the fraction for interpolation:
+    if (accumulator >= step)
+    {
+        const double dropped = std::floor(accumulator / step);
+        dropped_step_count += static_cast<uint64_t>(dropped);
+        accumulator -= dropped * step;
+    }
+
+    // Rounding may leave the accumulator marginally outside of [0; step):
+    if (accumulator < 0.0)
+        accumulator = 0.0;
+    if (accumulator >= step)
+    {
+        accumulator -= step;
+        ++steps;
+    }
+
+    step_count += steps;
+    return steps;
+}
+
+/*------------------------------------------------------------------*/
+// doctest:
+
+#include <doctest/doctest.h>
+
+TEST_CASE("testing simulation clock")
+{
+    SimulationClock clock { 30.0 };
+    CHECK(clock.get_step() == doctest::Approx(1.0 / 30.0));
+
+    // 144 Hz frames on a 30 Hz simulation: mostly no step, sometimes one.
+    uint32_t steps = 0;
+    for (int i = 0; i != 144; ++i)
+    {
+        steps += clock.advance(1.0 / 144.0);
+        CHECK(clock.get_alpha() >= 0.0);
+        CHECK(clock.get_alpha() < 1.0);
+    }
+    CHECK(steps >= 29);
+    CHECK(steps <= 30);
+    CHECK(clock.get_time() == doctest::Approx(steps / 30.0));
+
+    // A long stall is capped:
+    CHECK(clock.advance(10.0) == SimulationClock::DEFAULT_MAX_STEPS_PER_ADVANCE);
+    CHECK(clock.get_dropped_step_count() > 0);
+    CHECK(clock.get_alpha() < 1.0);
+
+    CHECK_THROWS(SimulationClock { 0.0 });
+}
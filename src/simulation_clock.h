@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+
+/*------------------------------------------------------------------*/
+// SimulationClock:
+// Decouples the simulation rate from the render rate: real frame time is accumulated (in double precision, so that long sessions do not drift), and consumed in fixed steps. Rendering then interpolates between the last two simulation steps by get_alpha(), which removes the jitter of a variable or mismatched rate (e.g. 30 Hz simulation at 144 Hz rendering).
+//   const uint32_t steps = clock.advance(elapsed_seconds);
+//   for (uint32_t i = 0; i != steps; ++i)
+//       simulate(clock.get_step());
+//   render(clock.get_alpha());
+
+class SimulationClock
+{
+public:
+    static constexpr uint32_t DEFAULT_MAX_STEPS_PER_ADVANCE = 8;
+
+    // Throws if rate is not positive.
+    explicit SimulationClock(const double rate = 60.0, const uint32_t max_steps_per_advance = DEFAULT_MAX_STEPS_PER_ADVANCE);
+
+    // Accumulates elapsed real time (in seconds) and returns the number of fixed steps to simulate now.
+    // At most max_steps_per_advance steps are returned; time beyond that is dropped, so that a long stall (or a simulation slower than real time) cannot make every following frame slower still.
+    uint32_t advance(const double elapsed_seconds);
+
+    double      get_step() const { return step; }               // In seconds.
+    double      get_alpha() const { return accumulator / step; } // In [0; 1): progress from the previous towards the current step.
+    uint64_t    get_step_count() const { return step_count; }
+    double      get_time() const { return step_count * step; }  // Simulated seconds.
+    uint64_t    get_dropped_step_count() const { return dropped_step_count; }
+
+private:
+    double      step;
+    uint32_t    max_steps_per_advance;
+
+    double      accumulator = 0.0;
+    uint64_t    step_count = 0;
+    uint64_t    dropped_step_count = 0;
+};
@@ -0,0 +1,58 @@
+#include "spsc_queue.h"
+
+/*------------------------------------------------------------------*/
+// doctest:
+
+#include <doctest/doctest.h>
+#include <thread>
+
+TEST_CASE("testing spsc queue")
+{
+    SUBCASE("testing bounds")
+    {
+        SpscQueue<int, 2> queue;
+        CHECK(queue.try_push(1));
+        CHECK(queue.try_push(2));
+        CHECK_FALSE(queue.try_push(3));
+
+        int value = 0;
+        CHECK(queue.try_pop(value));
+        CHECK(value == 1);
+        CHECK(queue.try_push(3));
+        CHECK(queue.try_pop(value));
+        CHECK(queue.try_pop(value));
+        CHECK(value == 3);
+        CHECK_FALSE(queue.try_pop(value));
+    }
+
+    SUBCASE("testing order across threads")
+    {
+        const int COUNT = 100'000;
+        SpscQueue<int, 16> queue;
+
+        std::thread producer { [&]
+        {
+            for (int i = 0; i < COUNT; ++i)
+            {
+                while (!queue.try_push(int { i }))
+                    std::this_thread::yield();
+            }
+        } };
+
+        bool in_order = true;
+        for (int expected = 0; expected < COUNT;)
+        {
+            int value = -1;
+            if (!queue.try_pop(value))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            in_order &= value == expected++;
+        }
+        producer.join();
+
+        CHECK(in_order);
+        CHECK(queue.size() == 0);
+    }
+}
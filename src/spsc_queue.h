@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+/*------------------------------------------------------------------*/
+// SpscQueue:
+// A bounded, lock-free queue for exactly one producer thread and one consumer thread. Both ends only touch their own index and read the other's, so neither ever waits for the other; a full queue rejects pushes instead of blocking, which bounds the latency of the queued items.
+// Capacity must be a power of two.
+
+template<typename T, size_t Capacity>
+class SpscQueue
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    // Producer only. Returns false (and leaves value untouched) if the queue is full.
+    bool try_push(T&& value)
+    {
+        const size_t tail = write_index.load(std::memory_order_relaxed);
+        if (tail - read_index.load(std::memory_order_acquire) == Capacity)
+            return false;
+
+        slots[tail & (Capacity - 1)] = std::move(value);
+        write_index.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Returns false if the queue is empty.
+    bool try_pop(T& value)
+    {
+        const size_t head = read_index.load(std::memory_order_relaxed);
+        if (head == write_index.load(std::memory_order_acquire))
+            return false;
+
+        value = std::move(slots[head & (Capacity - 1)]);
+        read_index.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate from any thread other than the producer and consumer.
+    size_t size() const
+    {
+        return write_index.load(std::memory_order_acquire) - read_index.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    // Separate cache lines, so that the producer and consumer do not invalidate each other's index on every operation (nor that of neighboring members of the owner).
+    // Explicit padding rather than alignas, which would over-align every class embedding the queue (MSVC warning C4324 under /WX):
+    std::byte                   padding_0[CACHE_LINE_SIZE];
+    std::atomic<size_t>         write_index { 0 };
+    std::byte                   padding_1[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t>         read_index { 0 };
+    std::byte                   padding_2[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+    std::array<T, Capacity>     slots {};
+};
@@ -0,0 +1,410 @@
+// rcl-bench: microbenchmarks of CPU hot paths.
+// Usage: rcl-bench [--filter substring] [--output results.json]
+// Every benchmark runs a fixed number of iterations per sample, so that results of different runs and machines are comparable. Results are written as JSON (to stdout, unless --output is given); progress goes to stderr.
+// Add a benchmark here before optimizing a perf-sensitive utility.
+
+#define DOCTEST_CONFIG_IMPLEMENT // Tests of the shared sources are registered, but only run by the main executable.
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <spdlog/async.h>
+#include <spdlog/details/log_msg.h>
+#include <spdlog/sinks/null_sink.h>
+
+#include "log.h"
+#include "error.h"
+#include "config.h"
+#include "json.h"
+#include "utility.h"
+#include "vki/vertex.h"
+#include "vki/mesh.h"
+
+/*------------------------------------------------------------------*/
+// Harness:
+
+const int SAMPLE_COUNT = 15;
+
+struct Benchmark
+{
+    std::string                         name;
+    uint64_t                            iterations; // Per sample; fixed.
+    std::function<uint64_t(uint64_t)>   run;        // Runs the given number of iterations; returns a checksum, which keeps the work from being optimized away.
+};
+
+struct BenchmarkResult
+{
+    std::string name;
+    uint64_t    iterations;
+    double      min_ns;     // Per iteration.
+    double      median_ns;
+    double      max_ns;
+};
+
+volatile uint64_t checksum_sink = 0;
+
+BenchmarkResult run_benchmark(const Benchmark& benchmark)
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Warm-up (caches, allocations, branch predictors):
+    checksum_sink = checksum_sink + benchmark.run(benchmark.iterations);
+
+    std::vector<double> samples;
+    for (int i = 0; i != SAMPLE_COUNT; ++i)
+    {
+        const auto begin = Clock::now();
+        checksum_sink = checksum_sink + benchmark.run(benchmark.iterations);
+        const std::chrono::duration<double, std::nano> duration = Clock::now() - begin;
+        samples.push_back(duration.count() / benchmark.iterations);
+    }
+    std::sort(samples.begin(), samples.end());
+
+    return BenchmarkResult {
+        .name       = benchmark.name,
+        .iterations = benchmark.iterations,
+        .min_ns     = samples.front(),
+        .median_ns  = samples[samples.size() / 2],
+        .max_ns     = samples.back(),
+    };
+}
+
+/*------------------------------------------------------------------*/
+// Data:
+
+// A triangle soup of cube faces, as produced by an OBJ file without shared vertices: every cube contributes 36 vertices, 24 of them unique.
+std::vector<vki::Vertex> generate_triangle_soup(const int cube_count)
+{
+    const auto cube = vki::generate_cube();
+
+    std::vector<vki::Vertex> soup;
+    soup.reserve(cube_count * cube.indices.size());
+    for (int i = 0; i != cube_count; ++i)
+    {
+        const glm::vec3 offset { static_cast<float>(i % 64), static_cast<float>(i / 64), 0.f };
+        for (const uint32_t index : cube.indices)
+        {
+            auto vertex = cube.vertices[index];
+            vertex.position += offset;
+            soup.push_back(vertex);
+        }
+    }
+    return soup;
+}
+
+// Writes an obj file of a size x size grid of quads (with texture coordinates and normals, like exported models) and returns its filename.
+std::string write_grid_obj(const int size)
+{
+    const auto filename = (std::filesystem::temp_directory_path() / "rcl-bench-grid.obj").string();
+    std::ofstream ofstr { filename };
+    if (!ofstr)
+        THROW_ERROR("file could not be opened for writing: {}", filename);
+
+    for (int y = 0; y <= size; ++y)
+        for (int x = 0; x <= size; ++x)
+            ofstr << fmt::format("v {} {} {}\nvt {} {}\n", x, 0.01f * ((x * y) % 7), y, static_cast<float>(x) / size, static_cast<float>(y) / size);
+    ofstr << "vn 0 1 0\n";
+
+    const auto index = [size](const int x, const int y) { return y * (size + 1) + x + 1; };
+    for (int y = 0; y != size; ++y)
+    {
+        for (int x = 0; x != size; ++x)
+        {
+            ofstr << fmt::format("f {0}/{0}/1 {1}/{1}/1 {2}/{2}/1 {3}/{3}/1\n",
+                index(x, y), index(x + 1, y), index(x + 1, y + 1), index(x, y + 1));
+        }
+    }
+    return filename;
+}
+
+/*------------------------------------------------------------------*/
+// Benchmarks:
+
+std::vector<Benchmark> create_benchmarks()
+{
+    std::vector<Benchmark> benchmarks;
+
+    /*------------------------------------------------------------------*/
+    // Vertices:
+
+    const auto soup = std::make_shared<std::vector<vki::Vertex>>(generate_triangle_soup(1024));
+
+    benchmarks.push_back(Benchmark {
+        .name       = "vertex_hash",
+        .iterations = 100,
+        .run        = [soup](const uint64_t iterations)
+        {
+            uint64_t checksum = 0;
+            for (uint64_t i = 0; i != iterations; ++i)
+                for (const auto& vertex : *soup)
+                    checksum += std::hash<vki::Vertex> {}(vertex);
+            return checksum;
+        },
+    });
+
+    // The deduplication of loaded meshes (see: vki::append_deduplicated, std::hash<vki::Vertex>):
+    benchmarks.push_back(Benchmark {
+        .name       = "vertex_dedup",
+        .iterations = 20,
+        .run        = [soup](const uint64_t iterations)
+        {
+            uint64_t checksum = 0;
+            for (uint64_t i = 0; i != iterations; ++i)
+            {
+                vki::MeshData mesh;
+                std::unordered_map<vki::Vertex, uint32_t> unique_vertices;
+                for (const auto& vertex : *soup)
+                    vki::append_deduplicated(mesh, vertex, unique_vertices);
+                checksum += mesh.vertices.size();
+            }
+            return checksum;
+        },
+    });
+
+    // 128 * 128 quads; iterations are whole files:
+    const auto grid_obj_filename = write_grid_obj(128);
+
+    benchmarks.push_back(Benchmark {
+        .name       = "load_obj",
+        .iterations = 2,
+        .run        = [grid_obj_filename](const uint64_t iterations)
+        {
+            uint64_t checksum = 0;
+            for (uint64_t i = 0; i != iterations; ++i)
+                checksum += vki::load_obj(grid_obj_filename, glm::vec3 { 1.f }).indices.size();
+            return checksum;
+        },
+    });
+
+    /*------------------------------------------------------------------*/
+    // Logging:
+
+    benchmarks.push_back(Benchmark {
+        .name       = "log_format",
+        .iterations = 100'000,
+        .run        = [](const uint64_t iterations)
+        {
+            const auto formatter = create_log_formatter();
+            const spdlog::details::log_msg msg {
+                spdlog::source_loc { __FILE__, __LINE__, "run" },
+                "bench",
+                spdlog::level::info,
+                "frame 1234 recorded; image: 1, instances: 256, batches: 1",
+            };
+
+            uint64_t checksum = 0;
+            spdlog::memory_buf_t buffer;
+            for (uint64_t i = 0; i != iterations; ++i)
+            {
+                buffer.clear();
+                formatter->format(msg, buffer);
+                checksum += buffer.size();
+            }
+            return checksum;
+        },
+    });
+
+    // The caller's side of a log call through the asynchronous logger (see: init_async_logger()): formatting the arguments and enqueueing the message. The queue can hold the messages of every sample, so that calls never wait for the worker, which writes them to a null sink.
+    const uint64_t log_macro_iterations = 1000;
+    const auto log_thread_pool = std::make_shared<spdlog::details::thread_pool>(2 * (SAMPLE_COUNT + 1) * log_macro_iterations, 1);
+    const auto async_logger = std::make_shared<spdlog::async_logger>(
+        "bench", std::make_shared<spdlog::sinks::null_sink_mt>(), log_thread_pool, spdlog::async_overflow_policy::block);
+    async_logger->set_level(spdlog::level::info);
+
+    benchmarks.push_back(Benchmark {
+        .name       = "log_macro_latency",
+        .iterations = log_macro_iterations,
+        .run        = [log_thread_pool, async_logger](const uint64_t iterations)
+        {
+            const auto previous_logger = spdlog::default_logger();
+            spdlog::set_default_logger(async_logger);
+            for (uint64_t i = 0; i != iterations; ++i)
+                LOG_INFO("frame {} recorded; image: {}, instances: {}, batches: {}", i, i % 3, 256, 1);
+            spdlog::set_default_logger(previous_logger);
+            return iterations;
+        },
+    });
+
+    /*------------------------------------------------------------------*/
+    // Config:
+
+    const auto config_filename = (std::filesystem::temp_directory_path() / "rcl-bench-config.json").string();
+
+    benchmarks.push_back(Benchmark {
+        .name       = "config_save",
+        .iterations = 200,
+        .run        = [config_filename](const uint64_t iterations)
+        {
+            Config config;
+            for (uint64_t i = 0; i != iterations; ++i)
+                config.save(config_filename);
+            return uint64_t { 0 };
+        },
+    });
+
+    benchmarks.push_back(Benchmark {
+        .name       = "config_load",
+        .iterations = 200,
+        .run        = [config_filename](const uint64_t iterations)
+        {
+            Config { }.save(config_filename);
+
+            uint64_t checksum = 0;
+            for (uint64_t i = 0; i != iterations; ++i)
+            {
+                Config config;
+                config.load(config_filename);
+                checksum += config.window_width;
+            }
+            return checksum;
+        },
+    });
+
+    /*------------------------------------------------------------------*/
+    // contains() (see: utility.h):
+
+    const auto numbers = std::make_shared<std::vector<int>>();
+    for (int i = 0; i != 1024; ++i)
+        numbers->push_back(i * 7);
+
+    // Sized like a device extension list:
+    static const std::vector<std::string> extension_names = []
+    {
+        std::vector<std::string> names;
+        for (int i = 0; i != 64; ++i)
+            names.push_back(fmt::format("VK_KHR_extension_name_{}", i));
+        return names;
+    }();
+    const auto extensions = std::make_shared<std::vector<const char*>>();
+    for (const auto& name : extension_names)
+        extensions->push_back(name.c_str());
+
+    const auto number_set = std::make_shared<std::unordered_set<int>>(numbers->begin(), numbers->end());
+
+    benchmarks.push_back(Benchmark {
+        .name       = "contains_vector",
+        .iterations = 10'000,
+        .run        = [numbers](const uint64_t iterations)
+        {
+            uint64_t checksum = 0;
+            for (uint64_t i = 0; i != iterations; ++i)
+                checksum += contains(*numbers, static_cast<int>(i % 2048) * 7); // Half of the lookups miss.
+            return checksum;
+        },
+    });
+
+    benchmarks.push_back(Benchmark {
+        .name       = "contains_cstring_vector",
+        .iterations = 10'000,
+        .run        = [extensions](const uint64_t iterations)
+        {
+            // Lookups use separate string copies, so that they are compared by content:
+            const std::string hit  = extension_names[extension_names.size() / 2];
+            const std::string miss = "VK_KHR_not_an_extension";
+
+            uint64_t checksum = 0;
+            for (uint64_t i = 0; i != iterations; ++i)
+            {
+                const char* name = (i % 2) ? hit.c_str() : miss.c_str();
+                checksum += contains(*extensions, name);
+            }
+            return checksum;
+        },
+    });
+
+    benchmarks.push_back(Benchmark {
+        .name       = "contains_unordered_set",
+        .iterations = 100'000,
+        .run        = [number_set](const uint64_t iterations)
+        {
+            uint64_t checksum = 0;
+            for (uint64_t i = 0; i != iterations; ++i)
+                checksum += contains(*number_set, static_cast<int>(i % 2048) * 7);
+            return checksum;
+        },
+    });
+
+    return benchmarks;
+}
+
+/*------------------------------------------------------------------*/
+
+int main(int argc, char** argv)
+{
+    std::string filter;
+    std::string output_filename;
+    for (int i = 1; i < argc; i += 2)
+    {
+        const std::string_view arg = argv[i];
+        if (arg != "--filter" && arg != "--output")
+        {
+            std::cerr << "unknown option: " << arg << '\n';
+            return EXIT_FAILURE;
+        }
+        if (i + 1 == argc)
+        {
+            std::cerr << "missing value for " << arg << '\n';
+            return EXIT_FAILURE;
+        }
+
+        if (arg == "--filter")
+            filter = argv[i + 1];
+        else
+            output_filename = argv[i + 1];
+    }
+
+    // Config load/save log every call:
+    spdlog::set_level(spdlog::level::off);
+
+    try
+    {
+        nlohmann::json results = nlohmann::json::array();
+        for (const auto& benchmark : create_benchmarks())
+        {
+            if (!filter.empty() && benchmark.name.find(filter) == std::string::npos)
+                continue;
+
+            const auto result = run_benchmark(benchmark);
+            std::cerr << fmt::format("{:<28} {:>12.1f} ns (min {:.1f}, max {:.1f})\n", result.name, result.median_ns, result.min_ns, result.max_ns);
+
+            results.push_back({
+                { "name",       result.name },
+                { "iterations", result.iterations },
+                { "samples",    SAMPLE_COUNT },
+                { "min_ns",     result.min_ns },
+                { "median_ns",  result.median_ns },
+                { "max_ns",     result.max_ns },
+            });
+        }
+
+        if (output_filename.empty())
+        {
+            std::cout << results.dump(4) << '\n';
+        }
+        else
+        {
+            std::ofstream ofstr { output_filename };
+            if (!ofstr)
+                THROW_ERROR("file could not be opened for writing: {}", output_filename);
+            ofstr << results.dump(4) << '\n';
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "error: " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
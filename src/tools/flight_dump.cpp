@@ -0,0 +1,32 @@
+// rcl-flight-dump: prints the records of a flight recorder file (see: flight_recorder.h).
+// Usage: rcl-flight-dump <file.flight> [last_seconds]
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+
+#include "flight_recorder.h"
+
+int main(int argc, char** argv)
+{
+    if (argc < 2 || argc > 3)
+    {
+        std::cerr << "usage: " << argv[0] << " <file.flight> [last_seconds]\n";
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        const double last_seconds = argc == 3 ? std::stod(argv[2]) : 0.0;
+        const auto records = flight_recorder::read_records(argv[1], last_seconds);
+        for (const auto& record : records)
+            std::cout << flight_recorder::format_record(record) << '\n';
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "error: " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,277 @@
+// rcl-perf: renders the test scene headless along a scripted camera path and reports CPU/GPU frame times and renderer counters (see: perf_report.h).
+// Usage: rcl-perf [--frames N] [--warmup N] [--width W] [--height H] [--scene test|1k|10k|100k|1m] [--seed S] [--transform push|uniform] [--output report.json] [--baseline baseline.json] [--write-baseline baseline.json]
+// Exits with EXIT_FAILURE if any metric regressed against the baseline. Runs on any Vulkan implementation, including Mesa's lavapipe:
+//   VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json rcl-perf --baseline assets/perf/baseline.lavapipe.json
+// assets/perf/baseline.json only holds the device independent counters, for runs on other devices.
+// --transform uniform renders with the per-vertex view * projection path that the push constant replaced, so that both can be compared on the same scene:
+//   rcl-perf --scene 10k --output push.json && rcl-perf --scene 10k --transform uniform --output uniform.json
+
+#define DOCTEST_CONFIG_IMPLEMENT // Tests of the shared sources are registered, but only run by the main executable.
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <charconv>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+
+#include "log.h"
+#include "binlog.h"
+#include "error.h"
+#include "perf_report.h"
+#include "vki/vulkan_interface.h"
+
+/*------------------------------------------------------------------*/
+// Options:
+
+struct PerfOptions
+{
+    uint32_t    frame_count     = 600;
+    uint32_t    warmup_count    = 60; // Not measured; covers pipeline warm-up and the first GPU timestamp readbacks.
+    uint32_t    width           = 1280;
+    uint32_t    height          = 720;
+    vki::ScenePreset scene      = vki::ScenePreset::Test;
+    uint64_t    seed            = 1;
+    bool        uniform_camera  = false; // See: Config::diagnostics_uniform_camera.
+    std::string output_filename = "perf_report.json";
+    std::string baseline_filename;
+    std::string write_baseline_filename;
+};
+
+PerfOptions parse_options(const int argc, const char* const* argv)
+{
+    PerfOptions options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        if (i + 1 >= argc)
+            THROW_ERROR("missing value for {}", arg);
+        const std::string_view value = argv[++i];
+
+        auto to_uint = [&](const uint64_t max = UINT32_MAX) -> uint64_t
+        {
+            uint64_t result = 0;
+            const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), result);
+            if (ec != std::errc {} || end != value.data() + value.size() || result > max)
+                THROW_ERROR("invalid value for {}: {}", arg, value);
+            return result;
+        };
+
+        if (arg == "--frames")
+            options.frame_count = static_cast<uint32_t>(to_uint());
+        else if (arg == "--warmup")
+            options.warmup_count = static_cast<uint32_t>(to_uint());
+        else if (arg == "--width")
+            options.width = static_cast<uint32_t>(to_uint());
+        else if (arg == "--height")
+            options.height = static_cast<uint32_t>(to_uint());
+        else if (arg == "--scene")
+            options.scene = vki::parse_scene_preset(value);
+        else if (arg == "--seed")
+            options.seed = to_uint(UINT64_MAX);
+        else if (arg == "--transform")
+        {
+            if (value != "push" && value != "uniform")
+                THROW_ERROR("invalid value for {}: {}", arg, value);
+            options.uniform_camera = value == "uniform";
+        }
+        else if (arg == "--output")
+            options.output_filename = value;
+        else if (arg == "--baseline")
+            options.baseline_filename = value;
+        else if (arg == "--write-baseline")
+            options.write_baseline_filename = value;
+        else
+            THROW_ERROR("unknown option: {}", arg);
+    }
+
+    if (options.frame_count == 0 || options.width == 0 || options.height == 0)
+        THROW_ERROR("frames, width and height must not be 0");
+
+    return options;
+}
+
+/*------------------------------------------------------------------*/
+// Measurement:
+
+const float FRAME_TIME = 1.f / 60.f; // In seconds; the scene and camera advance by a fixed step, so that every run renders the same frames.
+
+perf::Report measure(const PerfOptions& options)
+{
+    using Clock = std::chrono::steady_clock;
+
+    Config config; // Defaults only; a local config.json must not influence the measurement.
+    config.diagnostics_uniform_camera = options.uniform_camera;
+
+    vki::Scene scene;
+    if (options.scene != vki::ScenePreset::Test)
+    {
+        scene = vki::generate_stress_scene(vki::StressSceneCreateInfo {
+            .object_count   = vki::get_object_count(options.scene),
+            .seed           = options.seed,
+        });
+    }
+
+    VulkanRenderer renderer;
+    renderer.init(VulkanRendererInitInfo {
+        .config                 = config,
+        .application_name       = "rcl-perf",
+        .application_version    = std::make_tuple(2021, 2, 9),
+        .window                 = vkfw::Window {},
+        .headless_extent        = vk::Extent2D { .width = options.width, .height = options.height },
+        .scene                  = options.scene != vki::ScenePreset::Test ? &scene : nullptr,
+    });
+
+    const auto path = vki::generate_orbit_path(options.frame_count * FRAME_TIME);
+    const float elapsed_time = FRAME_TIME / 10.f; // In decaseconds (see: VulkanRenderer::update).
+
+    for (uint32_t i = 0; i != options.warmup_count; ++i)
+    {
+        path.apply(renderer.get_camera(), 0.f);
+        renderer.simulate(FRAME_TIME);
+        renderer.update(elapsed_time);
+    }
+
+    /*------------------------------------------------------------------*/
+    // Measured frames:
+
+    const auto stats_before = renderer.get_total_stats();
+
+    // CPU frame time is the wall time of update(), which includes waiting for a frame in flight; on a GPU bound scene it therefore approaches the GPU frame time.
+    std::vector<double> cpu_frame_ms;
+    cpu_frame_ms.reserve(options.frame_count);
+    for (uint32_t i = 0; i != options.frame_count; ++i)
+    {
+        path.apply(renderer.get_camera(), i * FRAME_TIME);
+        renderer.simulate(FRAME_TIME); // One simulation step per frame, so there is nothing to interpolate.
+
+        const auto begin = Clock::now();
+        renderer.update(elapsed_time);
+        cpu_frame_ms.push_back(std::chrono::duration<double, std::milli>(Clock::now() - begin).count());
+    }
+
+    const auto stats_after = renderer.get_total_stats();
+
+    /*------------------------------------------------------------------*/
+    // Report:
+
+    // Runs of the two transform paths must not be compared against each other's baseline:
+    perf::Report report {
+        .scene          = fmt::format("{}{}",
+                            options.scene == vki::ScenePreset::Test ?
+                                std::string { "cube_grid_orbit" } :
+                                fmt::format("stress_{}_seed_{}_orbit", vki::get_name(options.scene), options.seed),
+                            options.uniform_camera ? "_uniform_camera" : ""),
+        .device         = renderer.get_device_name(),
+        .width          = options.width,
+        .height         = options.height,
+        .frame_count    = options.frame_count,
+        .metrics        = {},
+    };
+
+    double cpu_sum = 0.0;
+    for (const double ms : cpu_frame_ms)
+        cpu_sum += ms;
+    report.metrics["cpu_frame_ms_avg"] = cpu_sum / cpu_frame_ms.size();
+    report.metrics["cpu_frame_ms_p50"] = perf::get_percentile(cpu_frame_ms, 0.50);
+    report.metrics["cpu_frame_ms_p95"] = perf::get_percentile(cpu_frame_ms, 0.95);
+    report.metrics["cpu_frame_ms_p99"] = perf::get_percentile(cpu_frame_ms, 0.99);
+    report.metrics["cpu_frame_ms_max"] = perf::get_percentile(cpu_frame_ms, 1.00);
+
+    // The GPU profiler keeps a rolling history, so these cover the most recent frames:
+    for (const auto& region : renderer.get_gpu_stats())
+    {
+        std::string name = region.name;
+        std::replace(name.begin(), name.end(), ' ', '_');
+        report.metrics[fmt::format("gpu_{}_ms_p50", name)] = region.p50_ms;
+        report.metrics[fmt::format("gpu_{}_ms_p95", name)] = region.p95_ms;
+        report.metrics[fmt::format("gpu_{}_ms_p99", name)] = region.p99_ms;
+    }
+
+    for (size_t i = 0; i != vki::stats::COUNTER_COUNT; ++i)
+    {
+        const auto counter = static_cast<vki::stats::Counter>(i);
+        const auto count = stats_after.get(counter) - stats_before.get(counter);
+        report.metrics[fmt::format("{}_per_frame", vki::stats::get_name(counter))] = static_cast<double>(count) / options.frame_count;
+    }
+
+    return report;
+}
+
+/*------------------------------------------------------------------*/
+
+void write_json(const std::string& filename, const nlohmann::json& json)
+{
+    std::ofstream ofstr { filename };
+    if (!ofstr)
+        THROW_ERROR("file could not be opened for writing: {}", filename);
+    ofstr << json.dump(4) << '\n';
+}
+
+int main(int argc, char** argv)
+{
+    int exit_code = EXIT_SUCCESS;
+    try
+    {
+        init_logger();
+        binlog::start();
+
+        const auto options = parse_options(argc, argv);
+        const auto report = measure(options);
+
+        write_json(options.output_filename, perf::to_json(report));
+        std::cout << "report written to " << options.output_filename << " (" << report.frame_count << " frames on " << report.device << ")\n";
+
+        if (!options.write_baseline_filename.empty())
+        {
+            write_json(options.write_baseline_filename, perf::create_baseline(report));
+            std::cout << "baseline written to " << options.write_baseline_filename << '\n';
+        }
+
+        if (!options.baseline_filename.empty())
+        {
+            std::ifstream ifstr { options.baseline_filename };
+            if (!ifstr)
+                THROW_ERROR("baseline could not be opened: {}", options.baseline_filename);
+            nlohmann::json baseline;
+            ifstr >> baseline;
+
+            const auto baseline_scene = baseline.value("scene", std::string {});
+            if (!baseline_scene.empty() && baseline_scene != report.scene)
+                LOG_WARNING("baseline was recorded with scene '{}', but this run used '{}'", baseline_scene, report.scene);
+
+            // Timings are only comparable on the same device:
+            const auto baseline_device = baseline.value("device", std::string {});
+            if (!baseline_device.empty() && baseline_device != report.device)
+                LOG_WARNING("baseline was recorded on '{}', but this run used '{}'", baseline_device, report.device);
+
+            size_t regression_count = 0;
+            for (const auto& comparison : perf::compare_to_baseline(report, baseline))
+            {
+                std::cout << fmt::format("{:<40} {:>12.4f} {:>12.4f} (limit {:.4f}) {}\n",
+                    comparison.metric, comparison.baseline, comparison.current, comparison.limit,
+                    comparison.regressed ? "REGRESSED" : "ok");
+                regression_count += comparison.regressed;
+            }
+
+            if (regression_count != 0)
+            {
+                std::cout << regression_count << " metric(s) regressed\n";
+                exit_code = EXIT_FAILURE;
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        LOG_ERROR("rcl-perf: {}", e.what());
+        exit_code = EXIT_FAILURE;
+    }
+
+    binlog::stop();
+    shutdown_logger();
+
+    return exit_code;
+}
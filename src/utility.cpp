@@ -4,6 +4,7 @@
 // doctest:
 
 #include <doctest/doctest.h>
+#include <cstdint>
 #include <vector>
 #include <set>
 
@@ -31,4 +32,13 @@ TEST_CASE("testing utility functions")
         CHECK(contains(cstrs_vec, bar));
         CHECK_FALSE(contains(cstrs_vec, foobar));
     }
+
+    SUBCASE("testing alignment functions")
+    {
+        CHECK(align_up(0, 256) == 0);
+        CHECK(align_up(1, 256) == 256);
+        CHECK(align_up(256, 256) == 256);
+        CHECK(align_up(257, 256) == 512);
+        CHECK(align_up<uint64_t>(65, 64) == 128);
+    }
 }
\ No newline at end of file
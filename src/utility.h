@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <cstring>
 #include <vector>
 #include <ctime>
 
@@ -47,6 +48,16 @@ template<>
     return std::find_if(vector.cbegin(), vector.cend(), comparator) != vector.cend();
 }
 
+/*------------------------------------------------------------------*/
+// Alignment:
+
+// Rounds value up to the next multiple of alignment (which must be a power of two).
+template<typename Num>
+[[nodiscard]] inline constexpr Num align_up(const Num value, const Num alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
 /*------------------------------------------------------------------*/
 // Bounds checking:
 
@@ -1,6 +1,53 @@
 #include "camera.h"
 
+#include <algorithm>
+#include <cassert>
+
 namespace vki
 {
 
-}
\ No newline at end of file
+void CameraPath::apply(Camera& camera, const float time) const
+{
+    assert(!keyframes.empty());
+
+    // First keyframe after time:
+    const auto next = std::upper_bound(keyframes.begin(), keyframes.end(), time,
+        [](const float t, const CameraKeyframe& keyframe) { return t < keyframe.time; });
+
+    if (next == keyframes.begin())
+    {
+        camera.look_at(keyframes.front().eye, keyframes.front().target);
+        return;
+    }
+    if (next == keyframes.end())
+    {
+        camera.look_at(keyframes.back().eye, keyframes.back().target);
+        return;
+    }
+
+    const auto& a = *(next - 1);
+    const auto& b = *next;
+    const float t = (time - a.time) / (b.time - a.time);
+    camera.look_at(glm::mix(a.eye, b.eye, t), glm::mix(a.target, b.target, t));
+}
+
+CameraPath generate_orbit_path(const float duration)
+{
+    const int KEYFRAME_COUNT = 32;
+
+    CameraPath path;
+    for (int i = 0; i <= KEYFRAME_COUNT; ++i)
+    {
+        const float s = static_cast<float>(i) / KEYFRAME_COUNT;
+        const float angle = s * glm::two_pi<float>();
+        const float distance = 1.2f + 0.6f * glm::cos(2.f * angle); // Close-ups fill the screen, distant views show the whole grid.
+        path.keyframes.push_back(CameraKeyframe {
+            .time   = s * duration,
+            .eye    = glm::vec3 { distance * glm::cos(angle), distance * glm::sin(angle), 0.6f + 0.4f * glm::sin(angle) },
+            .target = glm::vec3 { 0.f, 0.f, 0.f },
+        });
+    }
+    return path;
+}
+
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include "glm.h"
 
 namespace vki
@@ -12,6 +14,12 @@ struct Camera
         aspect_ratio = width / height;
     }
 
+    void look_at(const glm::vec3& new_eye, const glm::vec3& new_target)
+    {
+        eye    = new_eye;
+        target = new_target;
+    }
+
     glm::mat4 get_view() const
     {
         return glm::lookAt(eye, target, up);
@@ -26,6 +34,12 @@ struct Camera
         return projection;
     }
 
+    // Multiplied once per frame on the CPU, so that shaders only need a single matrix for the camera transform.
+    glm::mat4 get_view_projection() const
+    {
+        return get_projection() * get_view();
+    }
+
 private:
     glm::vec2 extent        = {};
     float     aspect_ratio  = {};
@@ -38,4 +52,28 @@ private:
 
     bool flip_y = true;
 };
+
+/*------------------------------------------------------------------*/
+// CameraPath:
+// A scripted flight through the scene, e.g. for reproducible performance measurements. Keyframes are linearly interpolated.
+
+struct CameraKeyframe
+{
+    float     time; // In seconds; keyframes are sorted by time.
+    glm::vec3 eye;
+    glm::vec3 target;
+};
+
+struct CameraPath
+{
+    std::vector<CameraKeyframe> keyframes;
+
+    // Clamps to the first/last keyframe outside of the path's time range.
+    void apply(Camera& camera, const float time) const;
+
+    float get_duration() const { return keyframes.empty() ? 0.f : keyframes.back().time; }
+};
+
+// Orbits the test scene once, while moving in and out.
+CameraPath generate_orbit_path(const float duration);
 }
\ No newline at end of file
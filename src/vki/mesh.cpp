@@ -0,0 +1,273 @@
+#include "mesh.h"
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+#include "error.h"
+
+namespace vki
+{
+MeshData generate_cube()
+{
+    return MeshData {
+        .vertices {
+            { { -0.5f, -0.5f, +0.5f }, { 0.7f, 0.2f, 0.2f } }, // top
+            { { +0.5f, -0.5f, +0.5f }, { 0.7f, 0.2f, 0.2f } },
+            { { +0.5f, +0.5f, +0.5f }, { 0.7f, 0.2f, 0.2f } },
+            { { -0.5f, +0.5f, +0.5f }, { 0.7f, 0.2f, 0.2f } },
+
+            { { -0.5f, -0.5f, -0.5f }, { 0.6f, 0.1f, 0.3f } }, // bottom
+            { { -0.5f, +0.5f, -0.5f }, { 0.6f, 0.1f, 0.3f } },
+            { { +0.5f, +0.5f, -0.5f }, { 0.6f, 0.1f, 0.3f } },
+            { { +0.5f, -0.5f, -0.5f }, { 0.6f, 0.1f, 0.3f } },
+
+            { { -0.5f, -0.5f, +0.5f }, { 0.2f, 0.5f, 0.4f } }, // left
+            { { -0.5f, +0.5f, +0.5f }, { 0.2f, 0.5f, 0.4f } },
+            { { -0.5f, +0.5f, -0.5f }, { 0.2f, 0.5f, 0.4f } },
+            { { -0.5f, -0.5f, -0.5f }, { 0.2f, 0.5f, 0.4f } },
+
+            { { +0.5f, -0.5f, +0.5f }, { 0.5f, 0.1f, 0.5f } }, // right
+            { { +0.5f, -0.5f, -0.5f }, { 0.5f, 0.1f, 0.5f } },
+            { { +0.5f, +0.5f, -0.5f }, { 0.5f, 0.1f, 0.5f } },
+            { { +0.5f, +0.5f, +0.5f }, { 0.5f, 0.1f, 0.5f } },
+
+            { { -0.5f, -0.5f, +0.5f }, { 0.6f, 0.5f, 0.1f } }, // back
+            { { -0.5f, -0.5f, -0.5f }, { 0.6f, 0.5f, 0.1f } },
+            { { +0.5f, -0.5f, -0.5f }, { 0.6f, 0.5f, 0.1f } },
+            { { +0.5f, -0.5f, +0.5f }, { 0.6f, 0.5f, 0.1f } },
+
+            { { -0.5f, +0.5f, +0.5f }, { 0.1f, 0.5f, 0.1f } }, // front
+            { { +0.5f, +0.5f, +0.5f }, { 0.1f, 0.5f, 0.1f } },
+            { { +0.5f, +0.5f, -0.5f }, { 0.1f, 0.5f, 0.1f } },
+            { { -0.5f, +0.5f, -0.5f }, { 0.1f, 0.5f, 0.1f } },
+        },
+        .indices {
+            0, 1, 2, 2, 3, 0,           // top
+            4, 5, 6, 6, 7, 4,           // bottom
+            8, 9, 10, 10, 11, 8,        // left
+            12, 13, 14, 14, 15, 12,     // right
+            16, 17, 18, 18, 19, 16,     // back
+            20, 21, 22, 22, 23, 20,     // front
+        },
+    };
+}
+
+MeshData generate_sphere(const uint32_t detail, const glm::vec3& color)
+{
+    assert(detail >= 3);
+
+    const uint32_t segments = detail;
+    const uint32_t rings    = std::max(2u, detail / 2);
+
+    MeshData mesh;
+    for (uint32_t ring = 0; ring <= rings; ++ring)
+    {
+        const float theta = glm::pi<float>() * ring / rings;
+        for (uint32_t segment = 0; segment <= segments; ++segment)
+        {
+            const float phi = glm::two_pi<float>() * segment / segments;
+            const glm::vec3 normal { glm::sin(theta) * glm::cos(phi), glm::sin(theta) * glm::sin(phi), glm::cos(theta) };
+            const float shade = 0.6f + 0.4f * normal.z; // Lit from above.
+            mesh.vertices.push_back(Vertex { .position = 0.5f * normal, .color = shade * color });
+        }
+    }
+
+    const uint32_t stride = segments + 1;
+    for (uint32_t ring = 0; ring != rings; ++ring)
+    {
+        for (uint32_t segment = 0; segment != segments; ++segment)
+        {
+            const uint32_t a = ring * stride + segment;
+            const uint32_t b = a + stride;
+            mesh.indices.insert(mesh.indices.end(), { a, b, a + 1, a + 1, b, b + 1 });
+        }
+    }
+    return mesh;
+}
+
+void append_deduplicated(MeshData& mesh, const Vertex& vertex, std::unordered_map<Vertex, uint32_t>& unique_vertices)
+{
+    const auto [it, inserted] = unique_vertices.try_emplace(vertex, static_cast<uint32_t>(mesh.vertices.size()));
+    if (inserted)
+        mesh.vertices.push_back(vertex);
+    mesh.indices.push_back(it->second);
+}
+
+MeshData load_obj(const std::string& filename, const glm::vec3& color)
+{
+    std::ifstream ifstr { filename };
+    if (!ifstr)
+        THROW_ERROR("obj file could not be opened: {}", filename);
+
+    std::vector<glm::vec3> positions;
+    MeshData mesh;
+    std::unordered_map<Vertex, uint32_t> unique_vertices;
+
+    // Resolves a face element ("v", "v/vt", "v//vn" or "v/vt/vn"; negative indices are relative to the end):
+    auto get_position = [&](const std::string& element, const size_t line_number) -> const glm::vec3&
+    {
+        int index = 0;
+        const auto [end, ec] = std::from_chars(element.data(), element.data() + element.size(), index);
+        if (ec != std::errc {} || index == 0)
+            THROW_ERROR("{}:{}: invalid face element: {}", filename, line_number, element);
+
+        const auto position_count = static_cast<int>(positions.size());
+        const int resolved = index > 0 ? index - 1 : position_count + index;
+        if (resolved < 0 || resolved >= position_count)
+            THROW_ERROR("{}:{}: vertex index out of range: {}", filename, line_number, index);
+        return positions[resolved];
+    };
+
+    std::string line;
+    std::vector<glm::vec3> face;
+    for (size_t line_number = 1; std::getline(ifstr, line); ++line_number)
+    {
+        std::istringstream stream { line };
+        std::string type;
+        stream >> type;
+
+        if (type == "v")
+        {
+            glm::vec3 position;
+            if (!(stream >> position.x >> position.y >> position.z))
+                THROW_ERROR("{}:{}: invalid vertex", filename, line_number);
+            positions.push_back(position);
+        }
+        else if (type == "f")
+        {
+            face.clear();
+            std::string element;
+            while (stream >> element)
+                face.push_back(get_position(element, line_number));
+            if (face.size() < 3)
+                THROW_ERROR("{}:{}: face has less than 3 vertices", filename, line_number);
+
+            // Lit from above (obj files are y-up); degenerate faces are fully lit:
+            const glm::vec3 normal = glm::cross(face[1] - face[0], face[2] - face[0]);
+            const float length = glm::length(normal);
+            const float shade = 0.6f + 0.4f * (length > 0.f ? std::abs(normal.y) / length : 1.f);
+
+            for (size_t i = 1; i + 1 < face.size(); ++i)
+            {
+                for (const auto& position : { face[0], face[i], face[i + 1] })
+                    append_deduplicated(mesh, Vertex { .position = position, .color = shade * color }, unique_vertices);
+            }
+        }
+    }
+
+    if (mesh.indices.empty())
+        THROW_ERROR("obj file has no faces: {}", filename);
+
+    return mesh;
+}
+
+BufferWrapper create_device_local_buffer(
+    const DeviceWrapper&        device_wrapper,
+    const void*                 data,
+    const vk::DeviceSize        size,
+    const vk::BufferUsageFlags  usage)
+{
+    auto device = device_wrapper.get();
+    assert(device);
+
+    auto staging_buffer = create_buffer(
+        device_wrapper,
+        size,
+        vk::BufferUsageFlagBits::eTransferSrc,
+        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+
+    void* mapped = device.mapMemory(staging_buffer.memory.get(), 0, size);
+    std::memcpy(mapped, data, static_cast<size_t>(size));
+    device.unmapMemory(staging_buffer.memory.get());
+
+    auto buffer = create_buffer(
+        device_wrapper,
+        size,
+        usage | vk::BufferUsageFlagBits::eTransferDst,
+        vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    copy_buffer(device_wrapper, staging_buffer.get(), buffer.get(), size);
+
+    return buffer;
+}
+
+MeshWrapper create_mesh(const DeviceWrapper& device_wrapper, const MeshData& mesh_data)
+{
+    const auto& vertices = mesh_data.vertices;
+    const auto& indices  = mesh_data.indices;
+
+    if (vertices.empty() || indices.empty())
+        THROW_ERROR("mesh has no vertices or indices; vertices: {}, indices: {}", vertices.size(), indices.size());
+
+    auto vertex_buffer = create_device_local_buffer(
+        device_wrapper,
+        vertices.data(),
+        sizeof(Vertex) * vertices.size(),
+        vk::BufferUsageFlagBits::eVertexBuffer);
+
+    auto index_buffer = create_device_local_buffer(
+        device_wrapper,
+        indices.data(),
+        sizeof(uint32_t) * indices.size(),
+        vk::BufferUsageFlagBits::eIndexBuffer);
+
+    return MeshWrapper {
+        .vertex_buffer  = std::move(vertex_buffer),
+        .index_buffer   = std::move(index_buffer),
+        .index_count    = static_cast<uint32_t>(indices.size()),
+    };
+}
+}
+
+/*------------------------------------------------------------------*/
+// doctest:
+
+#include <filesystem>
+
+#include <doctest/doctest.h>
+
+TEST_CASE("testing obj loading")
+{
+    const auto path = (std::filesystem::temp_directory_path() / "rcl_mesh_test.obj").string();
+    const auto load = [&](const std::string& text)
+    {
+        std::ofstream { path } << text;
+        return vki::load_obj(path, glm::vec3 { 1.f });
+    };
+
+    // Quads and n-gons are triangulated as fans around their first vertex:
+    const auto quad = load("v 0 0 0\nv 1 0 0\nv 1 0 1\nv 0 0 1\nf 1 2 3 4\n");
+    CHECK(quad.vertices.size() == 4);
+    CHECK(quad.indices == std::vector<uint32_t> { 0, 1, 2, 0, 2, 3 });
+
+    const auto pentagon = load("v 0 0 0\nv 2 0 0\nv 3 0 1\nv 1 0 2\nv -1 0 1\nf 1 2 3 4 5\n");
+    CHECK(pentagon.vertices.size() == 5);
+    CHECK(pentagon.indices == std::vector<uint32_t> { 0, 1, 2, 0, 2, 3, 0, 3, 4 });
+
+    // Negative indices are relative to the vertices read so far:
+    const auto relative = load("v 0 0 0\nv 1 0 0\nv 1 0 1\nf -3 -2 -1\nv 0 0 1\nf 1 3 -1\n");
+    CHECK(relative.vertices.size() == 4);
+    CHECK(relative.indices == std::vector<uint32_t> { 0, 1, 2, 0, 2, 3 });
+
+    // Texture coordinates and normals are optional and ignored:
+    const auto without_attributes = load("v 0 0 0\nv 1 0 0\nv 1 0 1\nf 1 2 3\n");
+    const auto with_attributes = load(
+        "v 0 0 0\nv 1 0 0\nv 1 0 1\nvt 0 0\nvn 0 1 0\n"
+        "f 1/1 2/1 3/1\nf 1//1 2//1 3//1\nf 1/1/1 2/1/1 3/1/1\n");
+    CHECK(with_attributes.vertices == without_attributes.vertices);
+    CHECK(with_attributes.indices.size() == 3 * without_attributes.indices.size());
+
+    // Malformed lines:
+    CHECK_THROWS(load("v 0 0\n"));                          // Missing coordinate.
+    CHECK_THROWS(load("v 0 0 0\nv 1 0 0\nf 1 2\n"));        // Less than 3 vertices.
+    CHECK_THROWS(load("v 0 0 0\nv 1 0 0\nf 1 2 4\n"));      // Out of range.
+    CHECK_THROWS(load("v 0 0 0\nv 1 0 0\nf 1 2 -3\n"));     // Relative, out of range.
+    CHECK_THROWS(load("v 0 0 0\nv 1 0 0\nv 1 0 1\nf 0 1 2\n"));
+    CHECK_THROWS(load("v 0 0 0\nv 1 0 0\nv 1 0 1\nf a b c\n"));
+    CHECK_THROWS(load("v 0 0 0\n"));                        // No faces.
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+#include "vertex.h"
+#include "vulkan_assist.h"
+
+namespace vki
+{
+/*------------------------------------------------------------------*/
+// MeshData:
+
+struct MeshData
+{
+    std::vector<Vertex>     vertices;
+    std::vector<uint32_t>   indices;
+};
+
+// Unit cube centered at the origin, one color per face.
+MeshData generate_cube();
+
+// UV sphere with a diameter of 1, centered at the origin. Detail is the number of segments around the z axis (rings are half of that); at least 3.
+MeshData generate_sphere(const uint32_t detail, const glm::vec3& color);
+
+// Appends an index for vertex to mesh; the vertex itself is only appended if unique_vertices (which maps each vertex of mesh to its index) does not contain it yet.
+void append_deduplicated(MeshData& mesh, const Vertex& vertex, std::unordered_map<Vertex, uint32_t>& unique_vertices);
+
+// Loads positions and faces (polygons are triangulated as fans); other statements are ignored. Faces are flat shaded by tinting color with their orientation, and identical vertices are merged. Throws if the file cannot be read or is malformed.
+MeshData load_obj(const std::string& filename, const glm::vec3& color);
+
+/*------------------------------------------------------------------*/
+// MeshWrapper:
+
+struct MeshWrapper
+{
+    BufferWrapper   vertex_buffer;
+    BufferWrapper   index_buffer;
+    uint32_t        index_count;
+};
+
+// Uploads vertices and indices into device local buffers (blocks until the upload is finished).
+MeshWrapper create_mesh(const DeviceWrapper& device_wrapper, const MeshData& mesh_data);
+
+// Creates a device local buffer and fills it with data through a temporary staging buffer (blocks until the upload is finished).
+BufferWrapper create_device_local_buffer(
+    const DeviceWrapper&        device_wrapper,
+    const void*                 data,
+    const vk::DeviceSize        size,
+    const vk::BufferUsageFlags  usage);
+}
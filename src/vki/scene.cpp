@@ -0,0 +1,269 @@
+#include "scene.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+#include "error.h"
+
+namespace vki
+{
+/*------------------------------------------------------------------*/
+// Constants:
+
+const std::array<glm::vec3, 4> MATERIAL_PALETTE {
+    glm::vec3 { 0.8f, 0.3f, 0.2f },
+    glm::vec3 { 0.2f, 0.6f, 0.3f },
+    glm::vec3 { 0.3f, 0.4f, 0.8f },
+    glm::vec3 { 0.8f, 0.7f, 0.3f },
+};
+
+constexpr std::array<uint32_t, 3> SPHERE_LOD_DETAIL { 32, 16, 8 };  // Segments; LOD 0 is the most detailed.
+constexpr std::array<float, 3>    SPHERE_LOD_WEIGHTS { 0.15f, 0.35f, 0.5f };
+
+// Share of objects per model kind; the loaded model gets its share only if a model file is given:
+const float MODEL_WEIGHT  = 0.2f;
+const float SPHERE_WEIGHT = 0.5f;
+
+const float SCENE_HALF_EXTENT = 1.f;    // Objects are placed in [-1; 1] x [-1; 1] x [-0.25; 0.25].
+const float SCENE_HALF_HEIGHT = 0.25f;
+
+/*------------------------------------------------------------------*/
+// Scene presets:
+
+ScenePreset parse_scene_preset(const std::string_view name)
+{
+    for (const auto preset : { ScenePreset::Test, ScenePreset::Objects1k, ScenePreset::Objects10k, ScenePreset::Objects100k, ScenePreset::Objects1M })
+    {
+        if (name == get_name(preset))
+            return preset;
+    }
+    THROW_ERROR("unknown scene preset: {} (expected: test, 1k, 10k, 100k or 1m)", name);
+}
+
+const char* get_name(const ScenePreset preset)
+{
+    switch (preset)
+    {
+    case ScenePreset::Test:         return "test";
+    case ScenePreset::Objects1k:    return "1k";
+    case ScenePreset::Objects10k:   return "10k";
+    case ScenePreset::Objects100k:  return "100k";
+    case ScenePreset::Objects1M:    return "1m";
+    }
+    return "unknown";
+}
+
+uint32_t get_object_count(const ScenePreset preset)
+{
+    switch (preset)
+    {
+    case ScenePreset::Test:         return 0;
+    case ScenePreset::Objects1k:    return 1'000;
+    case ScenePreset::Objects10k:   return 10'000;
+    case ScenePreset::Objects100k:  return 100'000;
+    case ScenePreset::Objects1M:    return 1'000'000;
+    }
+    return 0;
+}
+
+/*------------------------------------------------------------------*/
+// Random:
+
+// SplitMix64; unlike the std distributions, its results are specified exactly.
+class Random
+{
+public:
+    explicit Random(const uint64_t seed) : state(seed) {}
+
+    uint64_t next()
+    {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    // In [0; 1):
+    float next_float()
+    {
+        return static_cast<float>(next() >> 40) * (1.f / static_cast<float>(1u << 24));
+    }
+
+    float next_float(const float min, const float max)
+    {
+        return min + (max - min) * next_float();
+    }
+
+    uint32_t next_index(const uint32_t count)
+    {
+        return static_cast<uint32_t>(next() % count);
+    }
+
+    // Index of the weighted bucket; weights need not be normalized.
+    template<size_t N>
+    uint32_t next_weighted(const std::array<float, N>& weights)
+    {
+        float total = 0.f;
+        for (const float weight : weights)
+            total += weight;
+
+        float x = next_float() * total;
+        for (uint32_t i = 0; i != N; ++i)
+        {
+            if (x < weights[i])
+                return i;
+            x -= weights[i];
+        }
+        return N - 1;
+    }
+
+private:
+    uint64_t state;
+};
+
+/*------------------------------------------------------------------*/
+// Stress scene generator:
+
+// Centers the mesh and scales it to a maximum extent of 1, like the procedural meshes.
+void normalize_mesh(MeshData& mesh)
+{
+    glm::vec3 min { std::numeric_limits<float>::max() };
+    glm::vec3 max { std::numeric_limits<float>::lowest() };
+    for (const auto& vertex : mesh.vertices)
+    {
+        min = glm::min(min, vertex.position);
+        max = glm::max(max, vertex.position);
+    }
+
+    const glm::vec3 center = 0.5f * (min + max);
+    const glm::vec3 size   = max - min;
+    const float extent = std::max(size.x, std::max(size.y, size.z));
+    const float scale  = extent > 0.f ? 1.f / extent : 1.f;
+    for (auto& vertex : mesh.vertices)
+        vertex.position = (vertex.position - center) * scale;
+}
+
+// Appends one tinted copy per material; returns the index of the first one.
+uint32_t add_mesh_variants(Scene& scene, const MeshData& mesh)
+{
+    const auto first = static_cast<uint32_t>(scene.meshes.size());
+    for (const auto& color : MATERIAL_PALETTE)
+    {
+        auto variant = mesh;
+        for (auto& vertex : variant.vertices)
+            vertex.color *= color;
+        scene.meshes.push_back(std::move(variant));
+    }
+    return first;
+}
+
+Scene generate_stress_scene(const StressSceneCreateInfo& createinfo)
+{
+    Scene scene;
+
+    /*------------------------------------------------------------------*/
+    // Meshes (white, tinted per material):
+
+    const glm::vec3 white { 1.f, 1.f, 1.f };
+
+    const uint32_t cube_meshes = add_mesh_variants(scene, generate_cube());
+
+    std::array<uint32_t, SPHERE_LOD_DETAIL.size()> sphere_meshes;
+    for (size_t lod = 0; lod != SPHERE_LOD_DETAIL.size(); ++lod)
+        sphere_meshes[lod] = add_mesh_variants(scene, generate_sphere(SPHERE_LOD_DETAIL[lod], white));
+
+    const bool has_model = !createinfo.model_filename.empty();
+    uint32_t model_meshes = 0;
+    if (has_model)
+    {
+        auto model = load_obj(createinfo.model_filename, white);
+        normalize_mesh(model);
+        model_meshes = add_mesh_variants(scene, model);
+    }
+
+    /*------------------------------------------------------------------*/
+    // Objects:
+
+    Random random { createinfo.seed };
+
+    // Objects get smaller as the scene gets denser, so that their total volume stays about the same:
+    const float volume = 4.f * SCENE_HALF_EXTENT * SCENE_HALF_EXTENT * 2.f * SCENE_HALF_HEIGHT;
+    const float base_scale = 0.5f * std::cbrt(volume / std::max(createinfo.object_count, 1u));
+
+    const std::array<float, 3> kind_weights {
+        has_model ? MODEL_WEIGHT : 0.f,
+        SPHERE_WEIGHT,
+        1.f - MODEL_WEIGHT - SPHERE_WEIGHT,
+    };
+
+    scene.objects.reserve(createinfo.object_count);
+    for (uint32_t i = 0; i != createinfo.object_count; ++i)
+    {
+        const uint32_t material = random.next_index(static_cast<uint32_t>(MATERIAL_PALETTE.size()));
+
+        uint32_t mesh_index = 0;
+        switch (random.next_weighted(kind_weights))
+        {
+        case 0:  mesh_index = model_meshes; break;
+        case 1:  mesh_index = sphere_meshes[random.next_weighted(SPHERE_LOD_WEIGHTS)]; break;
+        default: mesh_index = cube_meshes; break;
+        }
+        mesh_index += material;
+
+        const glm::vec3 position {
+            random.next_float(-SCENE_HALF_EXTENT, SCENE_HALF_EXTENT),
+            random.next_float(-SCENE_HALF_EXTENT, SCENE_HALF_EXTENT),
+            random.next_float(-SCENE_HALF_HEIGHT, SCENE_HALF_HEIGHT),
+        };
+        glm::vec3 axis { random.next_float(-1.f, 1.f), random.next_float(-1.f, 1.f), random.next_float(-1.f, 1.f) };
+        if (glm::length(axis) < 1e-3f)
+            axis = glm::vec3 { 0.f, 0.f, 1.f };
+        const float angle = random.next_float(0.f, glm::two_pi<float>());
+        const float scale = base_scale * random.next_float(0.5f, 1.5f);
+
+        auto model = glm::translate(glm::mat4 { 1.f }, position);
+        model = glm::rotate(model, angle, glm::normalize(axis));
+        model = glm::scale(model, glm::vec3 { scale });
+
+        scene.objects.push_back(SceneObject {
+            .mesh_index = mesh_index,
+            .model      = model,
+        });
+    }
+
+    return scene;
+}
+}
+
+/*------------------------------------------------------------------*/
+// doctest:
+
+#include <doctest/doctest.h>
+
+TEST_CASE("testing stress scene generation")
+{
+    CHECK(vki::parse_scene_preset("100k") == vki::ScenePreset::Objects100k);
+    CHECK(vki::get_object_count(vki::parse_scene_preset("1m")) == 1'000'000);
+    CHECK_THROWS(vki::parse_scene_preset("2k"));
+
+    const vki::StressSceneCreateInfo createinfo {
+        .object_count   = 1000,
+        .seed           = 42,
+        .model_filename = "",
+    };
+    const auto a = vki::generate_stress_scene(createinfo);
+    const auto b = vki::generate_stress_scene(createinfo);
+    REQUIRE(a.objects.size() == 1000);
+    REQUIRE(a.meshes.size() == 4 * 4); // Cube and three sphere LODs, four materials each.
+
+    // Same seed, same scene:
+    bool identical = true;
+    for (size_t i = 0; i != a.objects.size(); ++i)
+        identical &= a.objects[i].mesh_index == b.objects[i].mesh_index && a.objects[i].model == b.objects[i].model;
+    CHECK(identical);
+
+    for (const auto& object : a.objects)
+        CHECK(object.mesh_index < a.meshes.size());
+}
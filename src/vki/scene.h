@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "glm.h"
+#include "mesh.h"
+
+namespace vki
+{
+/*------------------------------------------------------------------*/
+// Scene presets:
+
+enum class ScenePreset
+{
+    Test,           // The built-in spinning grid of cubes.
+    Objects1k,
+    Objects10k,
+    Objects100k,
+    Objects1M,
+};
+
+// Accepts "test", "1k", "10k", "100k" and "1m"; throws otherwise.
+ScenePreset parse_scene_preset(const std::string_view name);
+const char* get_name(const ScenePreset preset);
+uint32_t get_object_count(const ScenePreset preset); // 0 for the test scene.
+
+/*------------------------------------------------------------------*/
+// Scene:
+
+struct SceneObject
+{
+    uint32_t    mesh_index; // Into Scene::meshes.
+    glm::mat4   model;
+};
+
+struct Scene
+{
+    std::vector<MeshData>       meshes; // One per model, LOD and material combination, so that the instance batcher draws each with a single call.
+    std::vector<SceneObject>    objects;
+};
+
+/*------------------------------------------------------------------*/
+// Stress scene generator:
+// Places object_count instances of a loaded model and of procedural meshes (cubes, spheres with three LODs) in a slab around the origin, with random transforms, materials (color palettes, baked into the mesh variants) and LODs.
+// The generator uses its own random number generator and distributions, so that a seed yields the same random choices with every compiler and standard library: the same meshes, materials and LODs, and the same positions, rotation axes, angles and scales. Only the values derived from them through libm (sin, cos and cbrt in the transforms and sphere vertices) may differ in the last bits between standard libraries; within one build, a seed always yields a bit-identical scene.
+
+struct StressSceneCreateInfo
+{
+    uint32_t    object_count;
+    uint64_t    seed            = 1;
+    std::string model_filename  = "assets/models/viking.obj"; // Empty: procedural meshes only.
+};
+Scene generate_stress_scene(const StressSceneCreateInfo& createinfo);
+}
@@ -34,45 +34,29 @@ bool Vertex::operator==(const Vertex& other) const
     return position == other.position && color == other.color;
 }
 
+vk::VertexInputBindingDescription InstanceData::get_binding_description()
+{
+    return vk::VertexInputBindingDescription {
+        .binding    = 1,
+        .stride     = sizeof(InstanceData),
+        .inputRate  = vk::VertexInputRate::eInstance,
+    };
 }
 
-// const std::vector<Vertex> vertices {
-//     { { -0.5f,  -0.5f,  +0.5f }, { 0.7f, 0.2f, 0.2f }, { 0.f, 0.f } }, // top
-//     { { +0.5f,  -0.5f,  +0.5f }, { 0.7f, 0.2f, 0.2f }, { 1.f, 0.f } },
-//     { { +0.5f,  +0.5f,  +0.5f }, { 0.7f, 0.2f, 0.2f }, { 1.f, 1.f } },
-//     { { -0.5f,  +0.5f,  +0.5f }, { 0.7f, 0.2f, 0.2f }, { 0.f, 1.f } },
-
-//     { { -0.5f,  -0.5f,  -0.5f }, { 0.6f, 0.1f, 0.3f }, { 0.f, 0.f } }, // bottom
-//     { { -0.5f,  +0.5f,  -0.5f }, { 0.6f, 0.1f, 0.3f }, { 0.f, 1.f } },
-//     { { +0.5f,  +0.5f,  -0.5f }, { 0.6f, 0.1f, 0.3f }, { 1.f, 1.f } },
-//     { { +0.5f,  -0.5f,  -0.5f }, { 0.6f, 0.1f, 0.3f }, { 1.f, 0.f } },
-
-//     { { -0.5f,  -0.5f,  +0.5f }, { 0.2f, 0.5f, 0.4f }, { 0.f, 0.f } }, // left
-//     { { -0.5f,  +0.5f,  +0.5f }, { 0.2f, 0.5f, 0.4f }, { 1.f, 0.f } },
-//     { { -0.5f,  +0.5f,  -0.5f }, { 0.2f, 0.5f, 0.4f }, { 1.f, 1.f } },
-//     { { -0.5f,  -0.5f,  -0.5f }, { 0.2f, 0.5f, 0.4f }, { 0.f, 1.f } },
-
-//     { { +0.5f,  -0.5f,  +0.5f }, { 0.5f, 0.1f, 0.5f }, { 0.f, 0.f } }, // right
-//     { { +0.5f,  -0.5f,  -0.5f }, { 0.5f, 0.1f, 0.5f }, { 0.f, 1.f } },
-//     { { +0.5f,  +0.5f,  -0.5f }, { 0.5f, 0.1f, 0.5f }, { 1.f, 1.f } },
-//     { { +0.5f,  +0.5f,  +0.5f }, { 0.5f, 0.1f, 0.5f }, { 1.f, 0.f } },
-
-//     { { -0.5f,  -0.5f,  +0.5f }, { 0.6f, 0.5f, 0.1f }, { 0.f, 0.f } }, // back
-//     { { -0.5f,  -0.5f,  -0.5f }, { 0.6f, 0.5f, 0.1f }, { 0.f, 1.f } },
-//     { { +0.5f,  -0.5f,  -0.5f }, { 0.6f, 0.5f, 0.1f }, { 1.f, 1.f } },
-//     { { +0.5f,  -0.5f,  +0.5f }, { 0.6f, 0.5f, 0.1f }, { 1.f, 0.f } },
-
-//     { { -0.5f,  +0.5f,  +0.5f }, { 0.1f, 0.5f, 0.1f }, { 0.f, 0.f } }, // front
-//     { { +0.5f,  +0.5f,  +0.5f }, { 0.1f, 0.5f, 0.1f }, { 1.f, 0.f } },
-//     { { +0.5f,  +0.5f,  -0.5f }, { 0.1f, 0.5f, 0.1f }, { 1.f, 1.f } },
-//     { { -0.5f,  +0.5f,  -0.5f }, { 0.1f, 0.5f, 0.1f }, { 0.f, 1.f } },
-// };
+std::vector<vk::VertexInputAttributeDescription> InstanceData::get_attribute_descriptions()
+{
+    // A mat4 attribute occupies four consecutive locations, one per column:
+    std::vector<vk::VertexInputAttributeDescription> descriptions;
+    for (uint32_t column = 0; column != 4; ++column)
+    {
+        descriptions.emplace_back(vk::VertexInputAttributeDescription { // [2-5] -> model description
+            .location   = 2 + column,
+            .binding    = 1,
+            .format     = vk::Format::eR32G32B32A32Sfloat,
+            .offset     = static_cast<uint32_t>(offsetof(InstanceData, model) + column * sizeof(glm::vec4))
+        });
+    }
+    return descriptions;
+}
 
-// const std::vector<uint16_t> indices {
-//     0, 1, 2, 2, 3, 0,           // top
-//     4, 5, 6, 6, 7, 4,           // bottom
-//     8, 9, 10, 10, 11, 8,        // left
-//     12, 13, 14, 14, 15, 12,     // right
-//     16, 17, 18, 18, 19, 16,     // back
-//     20, 21, 22, 22, 23, 20,     // front
-// };
\ No newline at end of file
+}
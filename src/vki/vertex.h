@@ -20,6 +20,18 @@ struct Vertex
 
     bool operator==(const Vertex& other) const;
 };
+
+/*------------------------------------------------------------------*/
+// InstanceData:
+
+// Per-instance vertex input (binding 1). Instances sharing a mesh are drawn with a single drawIndexed (see also: vulkan_instancing.h).
+struct InstanceData
+{
+    glm::mat4 model;
+
+    static vk::VertexInputBindingDescription get_binding_description();
+    static std::vector<vk::VertexInputAttributeDescription> get_attribute_descriptions();
+};
 }
 
 // Hash for Vertex:
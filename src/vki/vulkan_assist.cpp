@@ -3,6 +3,7 @@
 #include <fstream>
 
 #include "error.h"
+#include "vulkan_stats.h"
 
 namespace vki
 {
@@ -64,6 +65,8 @@ void SingleTimeCommandBuffer::submit()
     };
     const auto fence = create_fence(device);
     queue.submit(std::vector<vk::SubmitInfo> { submit_info }, fence.get());
+    stats::add(stats::Counter::Submits);
+    stats::add(stats::Counter::BlockingSubmits);
 
     const auto res = device.waitForFences(std::vector<vk::Fence>{ fence.get() }, VK_TRUE, UINT64_MAX);
     if (res != vk::Result::eSuccess)
@@ -88,6 +91,7 @@ BufferWrapper create_buffer(
         .sharingMode    = vk::SharingMode::eExclusive,
     };
     auto buffer = device.createBufferUnique(buffer_createinfo);
+    stats::add(stats::Counter::ObjectCreations);
 
     // Allocate required buffer memory:
     const auto memory_requirements = device.getBufferMemoryRequirements(buffer.get());
@@ -96,6 +100,7 @@ BufferWrapper create_buffer(
         .memoryTypeIndex    = device_wrapper.get_memory_type_index(memory_requirements.memoryTypeBits, mem_properties),
     };
     auto memory = device.allocateMemoryUnique(allocate_info);
+    stats::add(stats::Counter::MemoryAllocations);
 
     // Bind:
     device.bindBufferMemory(buffer.get(), memory.get(), 0);
@@ -125,6 +130,7 @@ void copy_buffer(
     SingleTimeCommandBuffer cmdbuf { device, command_pool, transfer_queue };
     cmdbuf->copyBuffer(src, dst, std::vector<vk::BufferCopy> { {.size = size } });
     cmdbuf.submit();
+    stats::add(stats::Counter::BytesUploaded, size);
 }
 
 vk::ImageSubresourceRange create_ISR(
@@ -143,6 +149,20 @@ vk::ImageSubresourceRange create_ISR(
     };
 }
 
+bool has_stencil_component(const vk::Format format)
+{
+    switch (format)
+    {
+    case vk::Format::eS8Uint:
+    case vk::Format::eD16UnormS8Uint:
+    case vk::Format::eD24UnormS8Uint:
+    case vk::Format::eD32SfloatS8Uint:
+        return true;
+    default:
+        return false;
+    }
+}
+
 ImageWrapper create_image(const DeviceWrapper& device_wrapper, const ImageCreateInfo& createinfo)
 {
     const auto device = device_wrapper.get();
@@ -166,6 +186,7 @@ ImageWrapper create_image(const DeviceWrapper& device_wrapper, const ImageCreate
         .initialLayout  = vk::ImageLayout::eUndefined,
     };
     auto image = device.createImageUnique(image_createinfo);
+    stats::add(stats::Counter::ObjectCreations);
 
     // Allocate memory:
     const auto memory_requirements = device.getImageMemoryRequirements(image.get());
@@ -177,14 +198,19 @@ ImageWrapper create_image(const DeviceWrapper& device_wrapper, const ImageCreate
         .memoryTypeIndex    = memory_type_index,
     };
     auto memory = device.allocateMemoryUnique(allocate_info);
+    stats::add(stats::Counter::MemoryAllocations);
 
     // Derive aspect flags:
     vk::ImageAspectFlags aspect_flags;
 
-    if (createinfo.usage | vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eSampled)
-        aspect_flags |= vk::ImageAspectFlagBits::eColor;
-    if (createinfo.usage | vk::ImageUsageFlagBits::eDepthStencilAttachment)
-        aspect_flags |= vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil;
+    if (createinfo.usage & vk::ImageUsageFlagBits::eDepthStencilAttachment)
+    {
+        aspect_flags = vk::ImageAspectFlagBits::eDepth;
+        if (has_stencil_component(createinfo.format))
+            aspect_flags |= vk::ImageAspectFlagBits::eStencil;
+    }
+    else
+        aspect_flags = vk::ImageAspectFlagBits::eColor;
 
     // Bind:
     vkBindImageMemory(device, image.get(), memory.get(), 0);
@@ -286,6 +312,7 @@ void set_image_layout(
     }
 
     SingleTimeCommandBuffer cmdbuf { device, command_pool, graphics_queue };
+    stats::add(stats::Counter::Barriers);
     cmdbuf->pipelineBarrier(
         src_stage_mask,
         dst_stage_mask,
@@ -334,6 +361,22 @@ void copy_buffer_to_image(
                          vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllCommands);
 }
 
+vk::UniqueImageView create_image_view(const DeviceWrapper& device_wrapper, const ImageWrapper& image_wrapper)
+{
+    auto device = device_wrapper.get();
+    assert(device);
+    assert(image_wrapper.image);
+
+    const vk::ImageViewCreateInfo createinfo {
+        .image              = image_wrapper.get(),
+        .viewType           = vk::ImageViewType::e2D,
+        .format             = image_wrapper.format,
+        .subresourceRange   = create_ISR(image_wrapper.aspect, image_wrapper.mip_levels),
+    };
+    stats::add(stats::Counter::ObjectCreations);
+    return device.createImageViewUnique(createinfo);
+}
+
 void create_mipmaps(const DeviceWrapper& device_wrapper, ImageWrapper& image_wrapper)
 {
     auto device         = device_wrapper.device.get();
@@ -373,6 +416,7 @@ void create_mipmaps(const DeviceWrapper& device_wrapper, ImageWrapper& image_wra
         barrier.srcAccessMask   = vk::AccessFlagBits::eTransferWrite;
         barrier.dstAccessMask   = vk::AccessFlagBits::eTransferRead;
 
+        stats::add(stats::Counter::Barriers);
         cmdbuf->pipelineBarrier(
             vk::PipelineStageFlagBits::eTransfer,
             vk::PipelineStageFlagBits::eTransfer,
@@ -427,6 +471,7 @@ void create_mipmaps(const DeviceWrapper& device_wrapper, ImageWrapper& image_wra
         barrier.srcAccessMask   = vk::AccessFlagBits::eTransferRead;
         barrier.dstAccessMask   = vk::AccessFlagBits::eShaderRead;
 
+        stats::add(stats::Counter::Barriers);
         cmdbuf->pipelineBarrier(
             vk::PipelineStageFlagBits::eTransfer,
             vk::PipelineStageFlagBits::eFragmentShader,
@@ -451,6 +496,7 @@ void create_mipmaps(const DeviceWrapper& device_wrapper, ImageWrapper& image_wra
     barrier.srcAccessMask   = vk::AccessFlagBits::eTransferWrite;
     barrier.dstAccessMask   = vk::AccessFlagBits::eShaderRead;
 
+    stats::add(stats::Counter::Barriers);
     cmdbuf->pipelineBarrier(
         vk::PipelineStageFlagBits::eTransfer,
         vk::PipelineStageFlagBits::eFragmentShader,
@@ -491,6 +537,7 @@ vk::UniqueShaderModule create_shader_module(const DeviceWrapper& device_wrapper,
         .codeSize   = bytecode.size(),
         .pCode      = reinterpret_cast<const uint32_t*>(bytecode.data())
     };
+    stats::add(stats::Counter::ObjectCreations);
     return device.createShaderModuleUnique(createinfo);
 }
 
@@ -76,6 +76,8 @@ vk::ImageSubresourceRange create_ISR(
     const uint32_t              base_mip_level      = 0,
     const uint32_t              base_layer_level    = 0);
 
+bool has_stencil_component(const vk::Format format);
+
 struct ImageWrapper
 {
     vk::UniqueImage         image;
@@ -113,6 +115,8 @@ void copy_buffer_to_image(
     const vk::Buffer        buffer,
     ImageWrapper&           image_wrapper);
 
+vk::UniqueImageView create_image_view(const DeviceWrapper& device_wrapper, const ImageWrapper& image_wrapper);
+
 // Generates mipmaps for an existing and filled image.
 void create_mipmaps(const DeviceWrapper& device_wrapper, ImageWrapper& image_wrapper);
 
@@ -0,0 +1,192 @@
+#include "vulkan_bindless.h"
+
+#include "error.h"
+#include "vulkan_debug.h"
+#include "vulkan_stats.h"
+
+namespace vki
+{
+uint32_t BindlessTable::Slots::acquire()
+{
+    if (!free.empty())
+    {
+        const uint32_t index = free.back();
+        free.pop_back();
+        return index;
+    }
+
+    if (next == capacity)
+        THROW_ERROR("bindless table is full; capacity: {}", capacity);
+
+    return next++;
+}
+
+void BindlessTable::Slots::release(const uint32_t index)
+{
+    assert(index < next);
+    free.push_back(index);
+}
+
+BindlessTable::BindlessTable(const DeviceWrapper& device_wrapper, const uint32_t max_images, const uint32_t max_buffers) :
+    device { device_wrapper.get() }
+{
+    assert(device);
+
+    /*------------------------------------------------------------------*/
+    // Clamp to device limits:
+
+    const auto& limits_12 = device_wrapper.properties_12;
+
+    image_slots.capacity = std::min({
+        max_images,
+        limits_12.maxDescriptorSetUpdateAfterBindSampledImages,
+        limits_12.maxPerStageDescriptorUpdateAfterBindSampledImages,
+    });
+    buffer_slots.capacity = std::min({
+        max_buffers,
+        limits_12.maxDescriptorSetUpdateAfterBindStorageBuffers,
+        limits_12.maxPerStageDescriptorUpdateAfterBindStorageBuffers,
+    });
+
+    if (image_slots.capacity < max_images || buffer_slots.capacity < max_buffers)
+        LOG_WARNING("bindless table capacity had to be reduced; images: {}, buffers: {}", image_slots.capacity, buffer_slots.capacity);
+
+    /*------------------------------------------------------------------*/
+    // Layout:
+
+    const std::vector<vk::DescriptorSetLayoutBinding> bindings {
+        vk::DescriptorSetLayoutBinding {
+            .binding            = IMAGE_BINDING,
+            .descriptorType     = vk::DescriptorType::eCombinedImageSampler,
+            .descriptorCount    = image_slots.capacity,
+            .stageFlags         = vk::ShaderStageFlagBits::eAll,
+        },
+        vk::DescriptorSetLayoutBinding {
+            .binding            = BUFFER_BINDING,
+            .descriptorType     = vk::DescriptorType::eStorageBuffer,
+            .descriptorCount    = buffer_slots.capacity,
+            .stageFlags         = vk::ShaderStageFlagBits::eAll,
+        },
+    };
+
+    // Unused slots may stay unwritten, and slots may be written while the set is bound:
+    const vk::DescriptorBindingFlags binding_flags =
+        vk::DescriptorBindingFlagBits::ePartiallyBound |
+        vk::DescriptorBindingFlagBits::eUpdateAfterBind |
+        vk::DescriptorBindingFlagBits::eUpdateUnusedWhilePending;
+
+    const std::vector<vk::DescriptorBindingFlags> bindings_flags(bindings.size(), binding_flags);
+
+    const vk::DescriptorSetLayoutBindingFlagsCreateInfo binding_flags_createinfo {
+        .bindingCount   = static_cast<uint32_t>(bindings_flags.size()),
+        .pBindingFlags  = bindings_flags.data(),
+    };
+
+    const vk::DescriptorSetLayoutCreateInfo layout_createinfo {
+        .pNext          = &binding_flags_createinfo,
+        .flags          = vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool,
+        .bindingCount   = static_cast<uint32_t>(bindings.size()),
+        .pBindings      = bindings.data(),
+    };
+    layout = device.createDescriptorSetLayoutUnique(layout_createinfo);
+    set_object_name(device_wrapper, layout.get(), "BindlessSetLayout");
+
+    /*------------------------------------------------------------------*/
+    // Pool and set:
+
+    const std::vector<vk::DescriptorPoolSize> pool_sizes {
+        { .type = vk::DescriptorType::eCombinedImageSampler,    .descriptorCount = image_slots.capacity },
+        { .type = vk::DescriptorType::eStorageBuffer,           .descriptorCount = buffer_slots.capacity },
+    };
+    const vk::DescriptorPoolCreateInfo pool_createinfo {
+        .flags          = vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind,
+        .maxSets        = 1,
+        .poolSizeCount  = static_cast<uint32_t>(pool_sizes.size()),
+        .pPoolSizes     = pool_sizes.data(),
+    };
+    pool = device.createDescriptorPoolUnique(pool_createinfo);
+    stats::add(stats::Counter::ObjectCreations);
+
+    const vk::DescriptorSetAllocateInfo allocate_info {
+        .descriptorPool     = pool.get(),
+        .descriptorSetCount = 1,
+        .pSetLayouts        = &layout.get(),
+    };
+    set = device.allocateDescriptorSets(allocate_info).front();
+    set_object_name(device_wrapper, set, "BindlessSet");
+}
+
+uint32_t BindlessTable::add_image(const vk::ImageView image_view, const vk::Sampler sampler, const vk::ImageLayout layout)
+{
+    assert(set);
+
+    const uint32_t index = image_slots.acquire();
+
+    const vk::DescriptorImageInfo image_info {
+        .sampler        = sampler,
+        .imageView      = image_view,
+        .imageLayout    = layout,
+    };
+    const vk::WriteDescriptorSet write {
+        .dstSet             = set,
+        .dstBinding         = IMAGE_BINDING,
+        .dstArrayElement    = index,
+        .descriptorCount    = 1,
+        .descriptorType     = vk::DescriptorType::eCombinedImageSampler,
+        .pImageInfo         = &image_info,
+    };
+    device.updateDescriptorSets({ write }, {});
+    stats::add(stats::Counter::DescriptorUpdates);
+
+    return index;
+}
+
+uint32_t BindlessTable::add_buffer(const vk::Buffer buffer, const vk::DeviceSize offset, const vk::DeviceSize range)
+{
+    assert(set);
+
+    const uint32_t index = buffer_slots.acquire();
+
+    const vk::DescriptorBufferInfo buffer_info {
+        .buffer = buffer,
+        .offset = offset,
+        .range  = range,
+    };
+    const vk::WriteDescriptorSet write {
+        .dstSet             = set,
+        .dstBinding         = BUFFER_BINDING,
+        .dstArrayElement    = index,
+        .descriptorCount    = 1,
+        .descriptorType     = vk::DescriptorType::eStorageBuffer,
+        .pBufferInfo        = &buffer_info,
+    };
+    device.updateDescriptorSets({ write }, {});
+    stats::add(stats::Counter::DescriptorUpdates);
+
+    return index;
+}
+
+void BindlessTable::remove_image(const uint32_t index)
+{
+    image_slots.release(index);
+}
+
+void BindlessTable::remove_buffer(const uint32_t index)
+{
+    buffer_slots.release(index);
+}
+
+vk::PhysicalDeviceVulkan12Features get_bindless_required_features()
+{
+    return vk::PhysicalDeviceVulkan12Features {
+        .descriptorIndexing                             = VK_TRUE,
+        .shaderSampledImageArrayNonUniformIndexing      = VK_TRUE,
+        .shaderStorageBufferArrayNonUniformIndexing     = VK_TRUE,
+        .descriptorBindingSampledImageUpdateAfterBind   = VK_TRUE,
+        .descriptorBindingStorageBufferUpdateAfterBind  = VK_TRUE,
+        .descriptorBindingUpdateUnusedWhilePending      = VK_TRUE,
+        .descriptorBindingPartiallyBound                = VK_TRUE,
+        .runtimeDescriptorArray                         = VK_TRUE,
+    };
+}
+}
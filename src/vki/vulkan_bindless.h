@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+#include "vulkan_device.h"
+
+namespace vki
+{
+/*------------------------------------------------------------------*/
+// BindlessTable:
+
+// A single, large descriptor set with update-after-bind arrays of sampled images (binding 0) and storage buffers (binding 1). Resources are addressed from shaders by the index returned on registration (see also: assets/shaders/bindless.glsl), so the set only needs to be bound once per command buffer regardless of material.
+// Requires the descriptor indexing features of vulkan 1.2 (see: get_bindless_required_features()).
+class BindlessTable
+{
+public:
+    static constexpr uint32_t IMAGE_BINDING     = 0;
+    static constexpr uint32_t BUFFER_BINDING    = 1;
+
+    BindlessTable() = default;
+    BindlessTable(const DeviceWrapper& device_wrapper, const uint32_t max_images, const uint32_t max_buffers); // Counts are clamped to device limits.
+
+    // Slots of removed resources are reused; removing is only safe once the GPU no longer accesses the slot.
+    uint32_t add_image(const vk::ImageView image_view, const vk::Sampler sampler, const vk::ImageLayout layout = vk::ImageLayout::eShaderReadOnlyOptimal);
+    uint32_t add_buffer(const vk::Buffer buffer, const vk::DeviceSize offset = 0, const vk::DeviceSize range = VK_WHOLE_SIZE);
+    void remove_image(const uint32_t index);
+    void remove_buffer(const uint32_t index);
+
+    vk::DescriptorSetLayout get_layout() const { return layout.get(); }
+    vk::DescriptorSet       get_set() const { return set; }
+
+private:
+    struct Slots
+    {
+        uint32_t                capacity    = 0;
+        uint32_t                next        = 0; // Slots [next:capacity) have never been used.
+        std::vector<uint32_t>   free;
+
+        uint32_t acquire();
+        void release(const uint32_t index);
+    };
+
+    vk::Device                      device;
+    vk::UniqueDescriptorSetLayout   layout;
+    vk::UniqueDescriptorPool        pool;
+    vk::DescriptorSet               set; // Freed along with the pool.
+
+    Slots image_slots;
+    Slots buffer_slots;
+};
+
+// Vulkan 1.2 features which have to be enabled at create_device() for BindlessTable.
+vk::PhysicalDeviceVulkan12Features get_bindless_required_features();
+}
@@ -0,0 +1,54 @@
+#include "vulkan_deletion_queue.h"
+
+namespace vki
+{
+void DeletionQueue::collect(const uint64_t completed_frame_count)
+{
+    while (!entries.empty() && entries.front().frame_number <= completed_frame_count)
+        entries.pop_front();
+}
+
+void DeletionQueue::flush()
+{
+    while (!entries.empty())
+        entries.pop_front();
+}
+}
+
+/*------------------------------------------------------------------*/
+// doctest:
+
+#include <vector>
+
+#include <doctest/doctest.h>
+
+TEST_CASE("testing deletion queue")
+{
+    std::vector<int> destroyed;
+
+    struct Tracked
+    {
+        std::vector<int>* destroyed;
+        int id;
+
+        Tracked(std::vector<int>* destroyed, const int id) : destroyed(destroyed), id(id) {}
+        Tracked(Tracked&& other) noexcept : destroyed(std::exchange(other.destroyed, nullptr)), id(other.id) {}
+        ~Tracked() { if (destroyed) destroyed->push_back(id); }
+    };
+
+    vki::DeletionQueue queue;
+    queue.push(Tracked { &destroyed, 1 }, 1);
+    queue.push(Tracked { &destroyed, 2 }, 1);
+    queue.push(Tracked { &destroyed, 3 }, 3);
+    CHECK(destroyed.empty());
+
+    queue.collect(0);
+    CHECK(destroyed.empty());
+
+    queue.collect(2);
+    CHECK(destroyed == std::vector<int> { 1, 2 });
+    CHECK(queue.size() == 1);
+
+    queue.flush();
+    CHECK(destroyed == std::vector<int> { 1, 2, 3 });
+}
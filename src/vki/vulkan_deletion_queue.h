@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <utility>
+
+namespace vki
+{
+/*------------------------------------------------------------------*/
+// DeletionQueue:
+
+// Defers the destruction of resources the GPU may still be using, keyed by frame number:
+//   deletion_queue.push(std::move(framebuffer), frame_number);  // Not used by frame_number and later frames.
+//   ...
+//   deletion_queue.collect(completed_frame_count);               // Once their fences have been signaled.
+// Any movable owner works (vk::Unique* handles, wrappers, or structs of them); destroying it is what releases the resource. This replaces device-wide waits (waitIdle) whenever something in use has to be replaced: the old resource simply outlives the frames in flight.
+class DeletionQueue
+{
+public:
+    // Takes ownership of resource, which frames before frame_number may still use. Frame numbers must not decrease between pushes.
+    template<typename T>
+    void push(T&& resource, const uint64_t frame_number)
+    {
+        assert(entries.empty() || entries.back().frame_number <= frame_number);
+        entries.push_back(Entry {
+            .frame_number   = frame_number,
+            .resource       = std::make_unique<Resource<std::decay_t<T>>>(std::forward<T>(resource)),
+        });
+    }
+
+    // Destroys (in push order) the resources no longer used once the first completed_frame_count frames have completed.
+    void collect(const uint64_t completed_frame_count);
+
+    // Destroys everything; e.g. once the device is idle.
+    void flush();
+
+    size_t size() const { return entries.size(); }
+
+private:
+    struct ResourceBase
+    {
+        virtual ~ResourceBase() = default;
+    };
+
+    template<typename T>
+    struct Resource : ResourceBase
+    {
+        explicit Resource(T&& value) : value(std::move(value)) {}
+        explicit Resource(const T& value) : value(value) {}
+        T value;
+    };
+
+    struct Entry
+    {
+        uint64_t                        frame_number;
+        std::unique_ptr<ResourceBase>   resource;
+    };
+
+    std::deque<Entry> entries;
+};
+}
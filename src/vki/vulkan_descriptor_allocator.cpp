@@ -0,0 +1,267 @@
+#include "vulkan_descriptor_allocator.h"
+
+#include "error.h"
+#include "vulkan_debug.h"
+#include "vulkan_stats.h"
+
+namespace vki
+{
+/*------------------------------------------------------------------*/
+// Constants:
+
+const uint32_t MAX_SETS_PER_POOL = 4096;
+
+// Descriptors per set, for each type a pool is able to allocate:
+const std::vector<std::pair<vk::DescriptorType, float>> POOL_RATIOS {
+    { vk::DescriptorType::eUniformBuffer,           1.f },
+    { vk::DescriptorType::eUniformBufferDynamic,    1.f },
+    { vk::DescriptorType::eStorageBuffer,           1.f },
+    { vk::DescriptorType::eStorageBufferDynamic,    0.5f },
+    { vk::DescriptorType::eCombinedImageSampler,    2.f },
+    { vk::DescriptorType::eSampledImage,            1.f },
+    { vk::DescriptorType::eStorageImage,            0.5f },
+    { vk::DescriptorType::eSampler,                 0.5f },
+};
+
+/*------------------------------------------------------------------*/
+
+uint32_t get_next_sets_per_pool(const uint32_t sets_per_pool, const uint32_t allocated_sets, const uint32_t used_pool_count)
+{
+    if (used_pool_count <= 1)
+        return sets_per_pool;
+    return std::min(std::max(sets_per_pool, allocated_sets), MAX_SETS_PER_POOL);
+}
+
+DescriptorAllocator::DescriptorAllocator(const DeviceWrapper& device_wrapper, const uint32_t initial_sets_per_pool) :
+    device { device_wrapper.get() },
+    sets_per_pool { initial_sets_per_pool }
+{
+    assert(device);
+    assert(sets_per_pool > 0);
+}
+
+vk::DescriptorSet DescriptorAllocator::allocate(const vk::DescriptorSetLayout layout)
+{
+    assert(device);
+    assert(layout);
+
+    if (used_pools.empty())
+        next_pool();
+
+    // Try the current pool; if it is exhausted (or fragmented), move to the next pool and try once more:
+    for (int attempt = 0; attempt != 2; ++attempt)
+    {
+        const vk::DescriptorSetAllocateInfo allocate_info {
+            .descriptorPool     = used_pools.back().pool.get(),
+            .descriptorSetCount = 1,
+            .pSetLayouts        = &layout,
+        };
+
+        try
+        {
+            const auto set = device.allocateDescriptorSets(allocate_info).front();
+            ++allocated_sets;
+            return set;
+        }
+        catch (const vk::OutOfPoolMemoryError&)
+        {
+            ++failed_allocations;
+        }
+        catch (const vk::FragmentedPoolError&)
+        {
+            ++failed_allocations;
+        }
+
+        next_pool();
+    }
+
+    THROW_ERROR("descriptor set could not be allocated from a new pool; layout likely exceeds pool sizes");
+}
+
+void DescriptorAllocator::reset()
+{
+    assert(device);
+
+    previous_stats = get_stats();
+
+    // Size future pools by the usage observed since the last reset:
+    sets_per_pool = get_next_sets_per_pool(sets_per_pool, allocated_sets, static_cast<uint32_t>(used_pools.size()));
+
+    // Pools smaller than the new size are destroyed, so that the pool count converges to one per reset:
+    for (auto& pool : used_pools)
+    {
+        if (pool.set_count < sets_per_pool)
+            continue;
+
+        device.resetDescriptorPool(pool.pool.get());
+        free_pools.push_back(std::move(pool));
+    }
+    used_pools.clear();
+
+    allocated_sets  = 0;
+    set_capacity    = 0;
+}
+
+DescriptorAllocator::Stats DescriptorAllocator::get_stats() const
+{
+    return Stats {
+        .pool_count         = static_cast<uint32_t>(used_pools.size() + free_pools.size()),
+        .used_pool_count    = static_cast<uint32_t>(used_pools.size()),
+        .allocated_sets     = allocated_sets,
+        .set_capacity       = set_capacity,
+        .failed_allocations = failed_allocations,
+        .sets_per_pool      = sets_per_pool,
+    };
+}
+
+DescriptorAllocator::Pool DescriptorAllocator::create_pool(const uint32_t set_count) const
+{
+    std::vector<vk::DescriptorPoolSize> pool_sizes;
+    pool_sizes.reserve(POOL_RATIOS.size());
+    for (const auto& [type, ratio] : POOL_RATIOS)
+    {
+        pool_sizes.push_back(vk::DescriptorPoolSize {
+            .type               = type,
+            .descriptorCount    = std::max(1u, static_cast<uint32_t>(ratio * set_count)),
+        });
+    }
+
+    const vk::DescriptorPoolCreateInfo createinfo {
+        .maxSets        = set_count,
+        .poolSizeCount  = static_cast<uint32_t>(pool_sizes.size()),
+        .pPoolSizes     = pool_sizes.data(),
+    };
+    stats::add(stats::Counter::ObjectCreations);
+    return Pool {
+        .pool       = device.createDescriptorPoolUnique(createinfo),
+        .set_count  = set_count,
+    };
+}
+
+void DescriptorAllocator::next_pool()
+{
+    // Reuse a reset pool if there is one; otherwise create a new one:
+    if (!free_pools.empty())
+    {
+        used_pools.push_back(std::move(free_pools.back()));
+        free_pools.pop_back();
+    }
+    else
+    {
+        used_pools.push_back(create_pool(sets_per_pool));
+        LOG_DEBUG("descriptor pool created; sets per pool: {}, pool count: {}", sets_per_pool, used_pools.size());
+    }
+
+    set_capacity += used_pools.back().set_count;
+}
+
+/*------------------------------------------------------------------*/
+
+DescriptorSetCache::DescriptorSetCache(const DeviceWrapper& device_wrapper) :
+    device { device_wrapper.get() },
+    allocator { device_wrapper }
+{
+    assert(device);
+}
+
+vk::DescriptorSet DescriptorSetCache::get(const vk::DescriptorSetLayout layout, const std::vector<DescriptorBinding>& bindings)
+{
+    assert(device);
+
+    Key key { .layout = layout, .bindings = bindings };
+    if (const auto it = sets.find(key); it != sets.end())
+        return it->second;
+
+    /*------------------------------------------------------------------*/
+    // Allocate and write:
+
+    const auto set = allocator.allocate(layout);
+
+    std::vector<vk::DescriptorBufferInfo>   buffer_infos;
+    std::vector<vk::DescriptorImageInfo>    image_infos;
+    buffer_infos.reserve(bindings.size()); // Reserved so that pointers stay valid.
+    image_infos.reserve(bindings.size());
+
+    std::vector<vk::WriteDescriptorSet> writes;
+    for (const auto& binding : bindings)
+    {
+        vk::WriteDescriptorSet write {
+            .dstSet             = set,
+            .dstBinding         = binding.binding,
+            .dstArrayElement    = 0,
+            .descriptorCount    = 1,
+            .descriptorType     = binding.type,
+        };
+
+        if (binding.buffer)
+        {
+            buffer_infos.push_back(vk::DescriptorBufferInfo {
+                .buffer = binding.buffer,
+                .offset = binding.offset,
+                .range  = binding.range,
+            });
+            write.pBufferInfo = &buffer_infos.back();
+        }
+        else
+        {
+            image_infos.push_back(vk::DescriptorImageInfo {
+                .sampler        = binding.sampler,
+                .imageView      = binding.image_view,
+                .imageLayout    = binding.image_layout,
+            });
+            write.pImageInfo = &image_infos.back();
+        }
+
+        writes.push_back(write);
+    }
+    device.updateDescriptorSets(writes, {});
+    stats::add(stats::Counter::DescriptorUpdates, writes.size());
+
+    sets.emplace(std::move(key), set);
+    return set;
+}
+
+size_t DescriptorSetCache::KeyHash::operator()(const Key& key) const
+{
+    size_t hash = 0;
+    auto combine = [&hash](const uint64_t value)
+    {
+        hash ^= std::hash<uint64_t>()(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    };
+
+    combine(reinterpret_cast<uint64_t>(static_cast<VkDescriptorSetLayout>(key.layout)));
+    for (const auto& binding : key.bindings)
+    {
+        combine(binding.binding);
+        combine(static_cast<uint64_t>(binding.type));
+        combine(reinterpret_cast<uint64_t>(static_cast<VkBuffer>(binding.buffer)));
+        combine(binding.offset);
+        combine(binding.range);
+        combine(reinterpret_cast<uint64_t>(static_cast<VkImageView>(binding.image_view)));
+        combine(reinterpret_cast<uint64_t>(static_cast<VkSampler>(binding.sampler)));
+    }
+    return hash;
+}
+}
+
+/*------------------------------------------------------------------*/
+// doctest:
+
+#include <doctest/doctest.h>
+
+TEST_CASE("testing descriptor pool growth")
+{
+    using vki::get_next_sets_per_pool;
+
+    // Usage which fits into one pool keeps the size:
+    CHECK(get_next_sets_per_pool(64, 0, 0) == 64);
+    CHECK(get_next_sets_per_pool(64, 64, 1) == 64);
+
+    // Usage which spilled into more pools grows it to all sets, so that one pool suffices next time:
+    CHECK(get_next_sets_per_pool(64, 100, 2) == 100);
+    CHECK(get_next_sets_per_pool(64, 300, 5) == 300);
+
+    // Never shrinks, and is capped:
+    CHECK(get_next_sets_per_pool(256, 100, 2) == 256);
+    CHECK(get_next_sets_per_pool(64, 100'000, 3) == vki::MAX_SETS_PER_POOL);
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+#include "vulkan_device.h"
+
+namespace vki
+{
+/*------------------------------------------------------------------*/
+// DescriptorAllocator:
+
+// Allocates descriptor sets from a growing list of pools. Sets are never freed individually; instead, all pools are reset at once (e.g. once per frame in flight, after its fence has been signaled). The size of newly created pools follows the number of sets observed between resets.
+class DescriptorAllocator
+{
+public:
+    struct Stats
+    {
+        uint32_t pool_count;        // All pools, including unused (reset) ones.
+        uint32_t used_pool_count;   // Pools allocated from since the last reset.
+        uint32_t allocated_sets;    // Since the last reset.
+        uint32_t set_capacity;      // Of the used pools.
+        uint32_t failed_allocations;// Total number of out-of-pool-memory/fragmented-pool errors (each one moves allocation to another pool).
+        uint32_t sets_per_pool;     // Size of the next created pool.
+
+        float get_fragmentation() const { return set_capacity ? 1.f - static_cast<float>(allocated_sets) / set_capacity : 0.f; } // Share of capacity left unused in used pools.
+    };
+
+    DescriptorAllocator() = default;
+    DescriptorAllocator(const DeviceWrapper& device_wrapper, const uint32_t initial_sets_per_pool = 64);
+
+    vk::DescriptorSet allocate(const vk::DescriptorSetLayout layout);
+
+    // Invalidates all allocated sets. The usage up to the reset remains available through get_previous_stats().
+    void reset();
+
+    Stats get_stats() const; // Usage since the last reset.
+    const Stats& get_previous_stats() const { return previous_stats; } // Usage between the last two resets, captured before the last one; e.g. for reporting the usage of a whole frame.
+
+private:
+    struct Pool
+    {
+        vk::UniqueDescriptorPool    pool;
+        uint32_t                    set_count;
+    };
+
+    Pool create_pool(const uint32_t set_count) const;
+    void next_pool();
+
+    vk::Device  device;
+    uint32_t    sets_per_pool = 0;
+
+    std::vector<Pool> used_pools; // The last one is the current pool.
+    std::vector<Pool> free_pools;
+
+    uint32_t allocated_sets     = 0;
+    uint32_t set_capacity       = 0;
+    uint32_t failed_allocations = 0;
+
+    Stats previous_stats {};
+};
+
+// Growth policy of DescriptorAllocator: returns the size of pools created after a reset. If the sets allocated since the previous reset did not fit into a single pool, pools grow to hold all of them (up to a limit); they never shrink.
+uint32_t get_next_sets_per_pool(const uint32_t sets_per_pool, const uint32_t allocated_sets, const uint32_t used_pool_count);
+
+/*------------------------------------------------------------------*/
+// DescriptorSetCache:
+
+// A single descriptor of an immutable set.
+struct DescriptorBinding
+{
+    uint32_t            binding;
+    vk::DescriptorType  type;
+
+    // Buffers:
+    vk::Buffer          buffer;
+    vk::DeviceSize      offset  = 0;
+    vk::DeviceSize      range   = VK_WHOLE_SIZE;
+
+    // Images:
+    vk::ImageView       image_view;
+    vk::Sampler         sampler;
+    vk::ImageLayout     image_layout = vk::ImageLayout::eShaderReadOnlyOptimal;
+
+    bool operator==(const DescriptorBinding& other) const = default;
+};
+
+// Reuses descriptor sets which are never updated after being written: a set is keyed by its layout and contents, and is only allocated and written the first time it is requested.
+class DescriptorSetCache
+{
+public:
+    DescriptorSetCache() = default;
+    DescriptorSetCache(const DeviceWrapper& device_wrapper);
+
+    vk::DescriptorSet get(const vk::DescriptorSetLayout layout, const std::vector<DescriptorBinding>& bindings);
+
+    size_t size() const { return sets.size(); }
+    DescriptorAllocator::Stats get_stats() const { return allocator.get_stats(); }
+
+private:
+    struct Key
+    {
+        vk::DescriptorSetLayout         layout;
+        std::vector<DescriptorBinding>  bindings;
+
+        bool operator==(const Key& other) const = default;
+    };
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const;
+    };
+
+    vk::Device                                              device;
+    DescriptorAllocator                                     allocator; // Never reset.
+    std::unordered_map<Key, vk::DescriptorSet, KeyHash>     sets;
+};
+}
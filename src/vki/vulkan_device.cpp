@@ -5,6 +5,7 @@
 #include "vulkan_assist.h"
 #include "vulkan_debug.h"
 #include "error.h"
+#include "profiler.h"
 
 namespace vki
 {
@@ -92,10 +93,16 @@ uint32_t get_queue_family_index(const vk::PhysicalDevice physical_device, vk::Qu
         return false;                                                                           \
     }
 
+#define CHECK_FEATURE_12_SUPPORT(feature)                                                       \
+    if (createinfo.required_features_12.feature && !available_features_12.feature)              \
+    {                                                                                           \
+        LOG_WARNING("device does not support {} (vulkan 1.2)", #feature);                       \
+        return false;                                                                           \
+    }
+
 vk::PhysicalDevice get_optimal_physical_device(const DeviceCreateInfo& createinfo)
 {
     assert(createinfo.instance);
-    assert(createinfo.surface);
 
     /*------------------------------------------------------------------*/
     // Get all available physical devices:
@@ -195,6 +202,29 @@ vk::PhysicalDevice get_optimal_physical_device(const DeviceCreateInfo& createinf
         CHECK_FEATURE_SUPPORT(variableMultisampleRate);
         CHECK_FEATURE_SUPPORT(inheritedQueries);
 
+        const auto available_features_chain = device.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>();
+        const auto& available_features_12   = available_features_chain.get<vk::PhysicalDeviceVulkan12Features>();
+
+        CHECK_FEATURE_12_SUPPORT(samplerMirrorClampToEdge);
+        CHECK_FEATURE_12_SUPPORT(drawIndirectCount);
+        CHECK_FEATURE_12_SUPPORT(storageBuffer8BitAccess);
+        CHECK_FEATURE_12_SUPPORT(shaderFloat16);
+        CHECK_FEATURE_12_SUPPORT(shaderInt8);
+        CHECK_FEATURE_12_SUPPORT(descriptorIndexing);
+        CHECK_FEATURE_12_SUPPORT(shaderSampledImageArrayNonUniformIndexing);
+        CHECK_FEATURE_12_SUPPORT(shaderStorageBufferArrayNonUniformIndexing);
+        CHECK_FEATURE_12_SUPPORT(descriptorBindingUniformBufferUpdateAfterBind);
+        CHECK_FEATURE_12_SUPPORT(descriptorBindingSampledImageUpdateAfterBind);
+        CHECK_FEATURE_12_SUPPORT(descriptorBindingStorageBufferUpdateAfterBind);
+        CHECK_FEATURE_12_SUPPORT(descriptorBindingUpdateUnusedWhilePending);
+        CHECK_FEATURE_12_SUPPORT(descriptorBindingPartiallyBound);
+        CHECK_FEATURE_12_SUPPORT(descriptorBindingVariableDescriptorCount);
+        CHECK_FEATURE_12_SUPPORT(runtimeDescriptorArray);
+        CHECK_FEATURE_12_SUPPORT(scalarBlockLayout);
+        CHECK_FEATURE_12_SUPPORT(hostQueryReset);
+        CHECK_FEATURE_12_SUPPORT(timelineSemaphore);
+        CHECK_FEATURE_12_SUPPORT(bufferDeviceAddress);
+
         return true;
     };
 
@@ -250,6 +280,8 @@ vk::PhysicalDevice get_optimal_physical_device(const DeviceCreateInfo& createinf
 
 DeviceWrapper create_device(const DeviceCreateInfo& createinfo)
 {
+    PROFILE_FUNCTION();
+
     /*------------------------------------------------------------------*/
     // Pick physical device:
 
@@ -257,6 +289,13 @@ DeviceWrapper create_device(const DeviceCreateInfo& createinfo)
 
     auto enabled_features  = createinfo.required_features;
     auto properties        = physical_device.getProperties();
+
+    auto enabled_features_12 = createinfo.required_features_12;
+    enabled_features_12.pNext = nullptr;
+
+    auto properties_chain = physical_device.getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceVulkan12Properties>();
+    auto properties_12    = properties_chain.get<vk::PhysicalDeviceVulkan12Properties>();
+    properties_12.pNext   = nullptr;
     auto memory_properties = physical_device.getMemoryProperties();
 
     /*------------------------------------------------------------------*/
@@ -268,7 +307,7 @@ DeviceWrapper create_device(const DeviceCreateInfo& createinfo)
         .compute  = get_queue_family_index(physical_device, vk::QueueFlagBits::eCompute),
     };
 
-    if (!physical_device.getSurfaceSupportKHR(queue_family_indices.graphics, createinfo.surface))
+    if (createinfo.surface && !physical_device.getSurfaceSupportKHR(queue_family_indices.graphics, createinfo.surface))
         THROW_ERROR("graphics queue does not support presentation to surface");
 
     /*------------------------------------------------------------------*/
@@ -295,6 +334,7 @@ DeviceWrapper create_device(const DeviceCreateInfo& createinfo)
     // Create device:
 
     const vk::DeviceCreateInfo device_createinfo {
+        .pNext                      = &enabled_features_12,
         .queueCreateInfoCount       = static_cast<uint32_t>(queue_createinfos.size()),
         .pQueueCreateInfos          = queue_createinfos.data(),
         .enabledExtensionCount      = static_cast<uint32_t>(createinfo.required_extensions.size()),
@@ -334,7 +374,9 @@ DeviceWrapper create_device(const DeviceCreateInfo& createinfo)
         .physical_device        = std::move(physical_device),
         .device                 = std::move(device),
         .enabled_features       = std::move(enabled_features),
+        .enabled_features_12    = std::move(enabled_features_12),
         .properties             = std::move(properties),
+        .properties_12          = std::move(properties_12),
         .memory_properties      = std::move(memory_properties),
         .queue_family_indices   = std::move(queue_family_indices),
         .queues                 = std::move(queues),
@@ -15,7 +15,9 @@ struct DeviceWrapper
     vk::UniqueDevice    device;
     
     vk::PhysicalDeviceFeatures          enabled_features;
+    vk::PhysicalDeviceVulkan12Features  enabled_features_12; // pNext is always null.
     vk::PhysicalDeviceProperties        properties;
+    vk::PhysicalDeviceVulkan12Properties properties_12; // pNext is always null.
     vk::PhysicalDeviceMemoryProperties  memory_properties;
 
     struct QueueFamilyIndices
@@ -55,9 +57,10 @@ struct DeviceWrapper
 struct DeviceCreateInfo
 {
     vk::Instance                instance;
-    vk::SurfaceKHR              surface;
+    vk::SurfaceKHR              surface; // Optional, null for headless devices (presentation support is then not checked).
     std::vector<const char*>    required_extensions;
     vk::PhysicalDeviceFeatures  required_features;
+    vk::PhysicalDeviceVulkan12Features required_features_12; // Negotiated through the pNext chain of the device createinfo.
     bool                        debug_utils;
 };
 DeviceWrapper create_device(const DeviceCreateInfo& createinfo);
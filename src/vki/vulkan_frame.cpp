@@ -0,0 +1,48 @@
+#include "vulkan_frame.h"
+
+#include "vulkan_assist.h"
+#include "vulkan_debug.h"
+
+namespace vki
+{
+FrameWrapper create_frame(const DeviceWrapper& device_wrapper, const uint32_t frame_index)
+{
+    auto device = device_wrapper.get();
+    assert(device);
+
+    /*------------------------------------------------------------------*/
+    // Command pool and buffer:
+
+    const vk::CommandPoolCreateInfo command_pool_createinfo {
+        .flags              = vk::CommandPoolCreateFlagBits::eTransient,
+        .queueFamilyIndex   = device_wrapper.queue_family_indices.graphics,
+    };
+    auto command_pool = device.createCommandPoolUnique(command_pool_createinfo);
+
+    const vk::CommandBufferAllocateInfo allocate_info {
+        .commandPool        = command_pool.get(),
+        .level              = vk::CommandBufferLevel::ePrimary,
+        .commandBufferCount = 1,
+    };
+    auto cmdbuf = std::move(device.allocateCommandBuffersUnique(allocate_info).front());
+
+    /*------------------------------------------------------------------*/
+    // Sync:
+
+    auto image_available = device.createSemaphoreUnique(vk::SemaphoreCreateInfo {});
+    auto in_flight       = create_fence(device);
+
+    set_object_name(device_wrapper, command_pool.get(), fmt::format("FrameCommandPool_{}", frame_index));
+    set_object_name(device_wrapper, cmdbuf.get(), fmt::format("FrameCommandBuffer_{}", frame_index));
+
+    /*------------------------------------------------------------------*/
+    // Return:
+
+    return FrameWrapper {
+        .command_pool           = std::move(command_pool),
+        .cmdbuf                 = std::move(cmdbuf),
+        .image_available        = std::move(image_available),
+        .in_flight              = std::move(in_flight),
+    };
+}
+}
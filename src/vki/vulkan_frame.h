@@ -0,0 +1,25 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include "vulkan_device.h"
+#include "vulkan_instancing.h"
+
+namespace vki
+{
+/*------------------------------------------------------------------*/
+// FrameWrapper:
+
+// Resources owned by a single frame in flight. They may only be reused after in_flight has been signaled.
+struct FrameWrapper
+{
+    vk::UniqueCommandPool   command_pool; // Reset as a whole at the start of the frame.
+    vk::UniqueCommandBuffer cmdbuf;
+    vk::UniqueSemaphore     image_available;
+    vk::UniqueFence         in_flight;
+
+    InstanceBatcher         instance_batcher;
+};
+
+FrameWrapper create_frame(const DeviceWrapper& device_wrapper, const uint32_t frame_index);
+}
@@ -0,0 +1,170 @@
+#include "vulkan_gpu_profiler.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "log.h"
+#include "profiler.h"
+#include "vulkan_debug.h"
+#include "vulkan_stats.h"
+
+namespace vki
+{
+// Marks regions which ran out of queries:
+constexpr uint32_t INVALID_REGION = UINT32_MAX;
+
+GpuProfiler::GpuProfiler(const DeviceWrapper& device_wrapper, const uint32_t frame_count)
+{
+    device = device_wrapper.get();
+    assert(device);
+    assert(frame_count > 0);
+
+    const auto queue_families = device_wrapper.physical_device.getQueueFamilyProperties();
+    const uint32_t valid_bits = queue_families[device_wrapper.queue_family_indices.graphics].timestampValidBits;
+    if (valid_bits == 0)
+    {
+        LOG_WARNING("graphics queue does not support timestamps; GPU profiling disabled");
+        return;
+    }
+
+    timestamp_period = device_wrapper.properties.limits.timestampPeriod;
+    timestamp_mask = valid_bits >= 64 ? ~0ull : (1ull << valid_bits) - 1;
+
+    const vk::QueryPoolCreateInfo query_pool_createinfo {
+        .queryType  = vk::QueryType::eTimestamp,
+        .queryCount = MAX_REGIONS_PER_FRAME * 2,
+    };
+    for (uint32_t i = 0; i != frame_count; ++i)
+    {
+        Frame frame;
+        frame.query_pool = device.createQueryPoolUnique(query_pool_createinfo);
+        stats::add(stats::Counter::ObjectCreations);
+        set_object_name(device_wrapper, frame.query_pool.get(), fmt::format("GpuProfilerQueryPool_{}", i));
+        frames.push_back(std::move(frame));
+    }
+
+    profiler_track = profiler::create_track("GPU");
+}
+
+void GpuProfiler::begin_frame(const vk::CommandBuffer cmdbuf, const uint32_t frame_index)
+{
+    if (!is_supported())
+        return;
+
+    assert(frame_index < frames.size());
+    current_frame = frame_index;
+
+    read_back(frame_index);
+
+    auto& frame = frames[frame_index];
+    frame.region_names.clear();
+    frame.cpu_timestamp = profiler::get_timestamp();
+    cmdbuf.resetQueryPool(frame.query_pool.get(), 0, MAX_REGIONS_PER_FRAME * 2);
+}
+
+uint32_t GpuProfiler::begin_region(const vk::CommandBuffer cmdbuf, const char* name, const vk::PipelineStageFlagBits stage)
+{
+    if (!is_supported())
+        return INVALID_REGION;
+
+    auto& frame = frames[current_frame];
+    if (frame.region_names.size() == MAX_REGIONS_PER_FRAME)
+    {
+        LOG_WARNING_EVERY_MS(10'000, "GPU profiler region limit reached; region '{}' is not measured", name);
+        return INVALID_REGION;
+    }
+
+    const auto region = static_cast<uint32_t>(frame.region_names.size());
+    frame.region_names.push_back(name);
+    cmdbuf.writeTimestamp(stage, frame.query_pool.get(), region * 2);
+    return region;
+}
+
+void GpuProfiler::end_region(const vk::CommandBuffer cmdbuf, const uint32_t region, const vk::PipelineStageFlagBits stage)
+{
+    if (region == INVALID_REGION)
+        return;
+
+    cmdbuf.writeTimestamp(stage, frames[current_frame].query_pool.get(), region * 2 + 1);
+}
+
+void GpuProfiler::read_back(const uint32_t frame_index)
+{
+    auto& frame = frames[frame_index];
+    if (frame.region_names.empty())
+        return;
+
+    // Each query is followed by its availability; nothing is waited for:
+    const auto query_count = static_cast<uint32_t>(frame.region_names.size() * 2);
+    std::vector<uint64_t> results(query_count * 2);
+    const auto result = device.getQueryPoolResults(
+        frame.query_pool.get(), 0, query_count,
+        results.size() * sizeof(uint64_t), results.data(), 2 * sizeof(uint64_t),
+        vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWithAvailability);
+    if (result != vk::Result::eSuccess && result != vk::Result::eNotReady)
+    {
+        LOG_WARNING("GPU profiler results could not be read: {}", vk::to_string(result));
+        return;
+    }
+
+    const auto timestamp = [&](const uint32_t query) { return results[query * 2] & timestamp_mask; };
+    const auto available = [&](const uint32_t query) { return results[query * 2 + 1] != 0; };
+
+    // The first region's begin is anchored to the CPU time at which the frame was recorded:
+    if (!available(0))
+        return;
+    const uint64_t origin = timestamp(0);
+
+    for (uint32_t region = 0; region != frame.region_names.size(); ++region)
+    {
+        const uint32_t begin_query = region * 2;
+        const uint32_t end_query = begin_query + 1;
+        if (!available(begin_query) || !available(end_query))
+            continue;
+
+        const uint64_t begin = timestamp(begin_query);
+        const uint64_t end = timestamp(end_query);
+        if (end < begin)
+            continue;
+
+        const char* name = frame.region_names[region];
+        const double duration_ns = (end - begin) * timestamp_period;
+
+        auto& history = histories[name];
+        history.samples[history.count % HISTORY_SIZE] = duration_ns * 1e-6;
+        ++history.count;
+
+        const auto cpu_begin = frame.cpu_timestamp + static_cast<int64_t>((begin - origin) * timestamp_period);
+        profiler::record(profiler_track, name, cpu_begin, cpu_begin + static_cast<int64_t>(duration_ns));
+    }
+}
+
+std::vector<GpuRegionStats> GpuProfiler::get_stats() const
+{
+    std::vector<GpuRegionStats> stats;
+    for (const auto& [name, history] : histories)
+    {
+        const size_t count = std::min(history.count, HISTORY_SIZE);
+        if (count == 0)
+            continue;
+
+        std::vector<double> samples { history.samples.begin(), history.samples.begin() + count };
+        std::sort(samples.begin(), samples.end());
+        const auto percentile = [&](const double p)
+        {
+            return samples[std::min(count - 1, static_cast<size_t>(p * count))];
+        };
+
+        stats.push_back(GpuRegionStats {
+            .name           = name,
+            .sample_count   = count,
+            .average_ms     = std::accumulate(samples.begin(), samples.end(), 0.0) / count,
+            .p50_ms         = percentile(0.50),
+            .p95_ms         = percentile(0.95),
+            .p99_ms         = percentile(0.99),
+            .max_ms         = samples.back(),
+        });
+    }
+    return stats;
+}
+}
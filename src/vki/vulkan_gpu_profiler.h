@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <map>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+#include "vulkan_device.h"
+#include "profiler.h"
+
+namespace vki
+{
+/*------------------------------------------------------------------*/
+// GpuProfiler:
+
+struct GpuRegionStats
+{
+    std::string name;
+    size_t      sample_count;
+    double      average_ms;
+    double      p50_ms;
+    double      p95_ms;
+    double      p99_ms;
+    double      max_ms;
+};
+
+// Measures named regions of command buffers with timestamp query pairs. Each frame in flight has its own query pool; the results of a frame are read back (without waiting) the next time the same frame begins, i.e. once its fence has been signaled.
+// Completed regions are kept in a rolling history per name, and are also recorded to the CPU profiler's "GPU" track. The GPU timeline is anchored to the CPU time at which the frame was recorded, so it is only approximately aligned with CPU scopes.
+// If the graphics queue does not support timestamps, all calls do nothing.
+class GpuProfiler
+{
+public:
+    static constexpr uint32_t   MAX_REGIONS_PER_FRAME   = 32;
+    static constexpr size_t     HISTORY_SIZE            = 256; // Samples per region name.
+
+    GpuProfiler() = default;
+    GpuProfiler(const DeviceWrapper& device_wrapper, const uint32_t frame_count);
+
+    // Reads back the frame's previous results and resets its queries. Must only be called once the frame's fence has been signaled, with cmdbuf in the recording state and before any region is recorded.
+    void begin_frame(const vk::CommandBuffer cmdbuf, const uint32_t frame_index);
+
+    // Returns a region id for end_region(). The name must be a string literal, or otherwise outlive the profiler.
+    uint32_t begin_region(const vk::CommandBuffer cmdbuf, const char* name, const vk::PipelineStageFlagBits stage = vk::PipelineStageFlagBits::eTopOfPipe);
+    void end_region(const vk::CommandBuffer cmdbuf, const uint32_t region, const vk::PipelineStageFlagBits stage = vk::PipelineStageFlagBits::eBottomOfPipe);
+
+    std::vector<GpuRegionStats> get_stats() const;
+    bool is_supported() const { return !frames.empty(); }
+
+private:
+    void read_back(const uint32_t frame_index);
+
+private:
+    struct Frame
+    {
+        vk::UniqueQueryPool         query_pool;
+        std::vector<const char*>    region_names; // Region i uses queries 2i and 2i + 1.
+        int64_t                     cpu_timestamp = 0; // When the frame was recorded.
+    };
+
+    struct History
+    {
+        std::array<double, HISTORY_SIZE>    samples {}; // In milliseconds.
+        size_t                              count = 0;
+    };
+
+    vk::Device                      device;
+    double                          timestamp_period = 0.0; // Nanoseconds per tick.
+    uint64_t                        timestamp_mask = 0;
+    std::vector<Frame>              frames;
+    uint32_t                        current_frame = 0;
+    std::map<std::string, History>  histories;
+    profiler::Track                 profiler_track = nullptr;
+};
+}
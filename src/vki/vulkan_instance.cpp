@@ -4,6 +4,7 @@
 #include "error.h"
 #include "vulkan_debug.h"
 #include "vulkan_assist.h"
+#include "profiler.h"
 
 namespace vki
 {
@@ -17,6 +18,8 @@ const char* DEBUG_UTILS_EXTENSION_NAME = VK_EXT_DEBUG_UTILS_EXTENSION_NAME;
 
 vk::UniqueInstance create_instance(const InstanceCreateInfo& createinfo)
 {
+    PROFILE_FUNCTION();
+
     /*------------------------------------------------------------------*/
     // ApplicationInfo:
 
@@ -0,0 +1,160 @@
+#include "vulkan_instancing.h"
+
+#include "vulkan_debug.h"
+#include "vulkan_stats.h"
+
+namespace vki
+{
+void InstanceBatcher::clear()
+{
+    for (auto& mesh_instances : instances_by_mesh)
+        mesh_instances.instances.clear();
+
+    batches.clear();
+    packed_instances.clear();
+}
+
+void InstanceBatcher::add(const MeshWrapper& mesh, const InstanceData& instance)
+{
+    const auto [it, inserted] = mesh_indices.try_emplace(&mesh, static_cast<uint32_t>(instances_by_mesh.size()));
+    if (inserted)
+        instances_by_mesh.push_back(MeshInstances { .mesh = &mesh, .instances = {} });
+    instances_by_mesh[it->second].instances.push_back(instance);
+}
+
+void InstanceBatcher::build()
+{
+    batches.clear();
+    packed_instances.clear();
+
+    for (const auto& [mesh, instances] : instances_by_mesh)
+    {
+        if (instances.empty())
+            continue;
+
+        batches.push_back(Batch {
+            .mesh           = mesh,
+            .first_instance = static_cast<uint32_t>(packed_instances.size()),
+            .instance_count = static_cast<uint32_t>(instances.size()),
+        });
+        packed_instances.insert(packed_instances.end(), instances.cbegin(), instances.cend());
+    }
+}
+
+void InstanceBatcher::upload(const DeviceWrapper& device_wrapper)
+{
+    auto device = device_wrapper.get();
+    assert(device);
+
+    if (packed_instances.empty())
+        return;
+
+    assert(!instance_buffer.buffer || instance_buffer_mapped); // Not uploaded with upload_static().
+
+    const vk::DeviceSize required_size = sizeof(InstanceData) * packed_instances.size();
+
+    // Grow (to the next power of two, to avoid reallocating every frame while the scene grows):
+    if (!instance_buffer.buffer || instance_buffer.size < required_size)
+    {
+        vk::DeviceSize size = sizeof(InstanceData);
+        while (size < required_size)
+            size *= 2;
+
+        instance_buffer = create_buffer(
+            device_wrapper,
+            size,
+            vk::BufferUsageFlagBits::eVertexBuffer,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+        set_object_name(device_wrapper, instance_buffer.get(), "InstanceBuffer");
+
+        instance_buffer_mapped = device.mapMemory(instance_buffer.memory.get(), 0, size);
+    }
+
+    std::memcpy(instance_buffer_mapped, packed_instances.data(), static_cast<size_t>(required_size));
+    stats::add(stats::Counter::BytesUploaded, required_size);
+}
+
+void InstanceBatcher::upload_static(const DeviceWrapper& device_wrapper)
+{
+    if (packed_instances.empty())
+        return;
+
+    const vk::DeviceSize size = sizeof(InstanceData) * packed_instances.size();
+    instance_buffer = create_device_local_buffer(device_wrapper, packed_instances.data(), size, vk::BufferUsageFlagBits::eVertexBuffer);
+    instance_buffer_mapped = nullptr;
+    set_object_name(device_wrapper, instance_buffer.get(), "StaticInstanceBuffer");
+    stats::add(stats::Counter::BytesUploaded, size);
+
+    // Only the packed copy is kept; the per-mesh lists would otherwise double the memory of a large scene:
+    instances_by_mesh = {};
+    mesh_indices = {};
+}
+
+void InstanceBatcher::record(const vk::CommandBuffer cmdbuf) const
+{
+    assert(cmdbuf);
+
+    if (batches.empty())
+        return;
+
+    assert(instance_buffer.buffer);
+
+    // Instance-rate attributes are fetched at (firstInstance + gl_InstanceIndex), so the instance buffer is bound once at offset 0:
+    cmdbuf.bindVertexBuffers(1, { instance_buffer.get() }, { vk::DeviceSize { 0 } });
+
+    for (const auto& batch : batches)
+    {
+        cmdbuf.bindVertexBuffers(0, { batch.mesh->vertex_buffer.get() }, { vk::DeviceSize { 0 } });
+        cmdbuf.bindIndexBuffer(batch.mesh->index_buffer.get(), 0, vk::IndexType::eUint32);
+        cmdbuf.drawIndexed(batch.mesh->index_count, batch.instance_count, 0, 0, batch.first_instance);
+
+        stats::add(stats::Counter::Draws);
+        stats::add(stats::Counter::Triangles, uint64_t { batch.mesh->index_count / 3 } * batch.instance_count);
+    }
+}
+}
+
+/*------------------------------------------------------------------*/
+// doctest:
+
+#include <doctest/doctest.h>
+
+TEST_CASE("testing instance batching")
+{
+    using namespace vki;
+
+    const MeshWrapper mesh_a {};
+    const MeshWrapper mesh_b {};
+
+    InstanceBatcher batcher;
+    for (int i = 0; i != 3; ++i)
+    {
+        batcher.add(mesh_a, InstanceData { .model = glm::mat4 { static_cast<float>(i) } });
+        batcher.add(mesh_b, InstanceData { .model = glm::mat4 { 1.f } });
+    }
+    batcher.build();
+
+    const auto& batches = batcher.get_batches();
+    REQUIRE(batches.size() == 2);
+    CHECK(batches[0].instance_count == 3);
+    CHECK(batches[1].instance_count == 3);
+    CHECK(batches[0].first_instance + batches[0].instance_count == batches[1].first_instance);
+    CHECK(batcher.get_instances().size() == 6);
+
+    // Batches follow the order in which their meshes were first added, and instances of the same mesh keep their submission order:
+    CHECK(batches[0].mesh == &mesh_a);
+    CHECK(batches[1].mesh == &mesh_b);
+    for (uint32_t i = 0; i != 3; ++i)
+        CHECK(batcher.get_instances()[batches[0].first_instance + i].model == glm::mat4 { static_cast<float>(i) });
+
+    batcher.clear();
+    batcher.build();
+    CHECK(batcher.get_batches().empty());
+
+    InstanceBatcher reversed;
+    reversed.add(mesh_b, InstanceData {});
+    reversed.add(mesh_a, InstanceData {});
+    reversed.build();
+    REQUIRE(reversed.get_batches().size() == 2);
+    CHECK(reversed.get_batches()[0].mesh == &mesh_b);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+#include "mesh.h"
+#include "vertex.h"
+#include "vulkan_assist.h"
+
+namespace vki
+{
+/*------------------------------------------------------------------*/
+// InstanceBatcher:
+
+// Collects instances per frame and groups them by mesh, so that all instances of a mesh are drawn with a single drawIndexed. Batches are ordered by when their mesh was first added, so the draw order does not depend on mesh addresses. The instance buffer is overwritten on every upload(), hence one batcher should be used per frame in flight.
+// Instances which never change (e.g. a static scene) are instead built and uploaded once with upload_static(); such a batcher may be recorded by every frame in flight.
+class InstanceBatcher
+{
+public:
+    struct Batch
+    {
+        const MeshWrapper*  mesh;
+        uint32_t            first_instance;
+        uint32_t            instance_count;
+    };
+
+    void clear(); // Keeps allocated memory for the next frame.
+    void add(const MeshWrapper& mesh, const InstanceData& instance);
+
+    void build(); // Groups instances by mesh into contiguous ranges.
+    void upload(const DeviceWrapper& device_wrapper); // Copies built instances into the (host visible) instance buffer, growing it if necessary.
+    void upload_static(const DeviceWrapper& device_wrapper); // Copies built instances into a device local instance buffer (blocks until the upload is finished). The batcher must not be changed afterwards.
+    void record(const vk::CommandBuffer cmdbuf) const; // Binds buffers and issues one drawIndexed per batch.
+
+    const std::vector<Batch>&           get_batches() const { return batches; }
+    const std::vector<InstanceData>&    get_instances() const { return packed_instances; }
+
+private:
+    struct MeshInstances
+    {
+        const MeshWrapper*          mesh;
+        std::vector<InstanceData>   instances;
+    };
+    std::vector<MeshInstances>                          instances_by_mesh; // In order of first add().
+    std::unordered_map<const MeshWrapper*, uint32_t>    mesh_indices; // Into instances_by_mesh.
+
+    std::vector<Batch>          batches;
+    std::vector<InstanceData>   packed_instances;
+
+    BufferWrapper   instance_buffer;
+    void*           instance_buffer_mapped = nullptr;
+};
+}
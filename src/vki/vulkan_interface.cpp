@@ -6,8 +6,23 @@
 #include "vulkan_instance.h"
 #include "vulkan_renderpass.h"
 
+#include "error.h"
+#include "binlog.h"
+#include "profiler.h"
+
 using namespace vki;
 
+/*------------------------------------------------------------------*/
+// Constants:
+
+const uint32_t MAX_FRAMES_IN_FLIGHT = 2; // 1 in low latency mode.
+const vk::DeviceSize UNIFORM_RING_FRAME_SIZE = 64 * 1024;
+
+
+const vk::Format OFFSCREEN_COLOR_FORMAT = vk::Format::eR8G8B8A8Unorm;
+
+const int SCENE_GRID_SIZE = 16; // The test scene is a SCENE_GRID_SIZE^2 grid of instanced cubes.
+
 /*------------------------------------------------------------------*/
 // Default dispatcher:
 
@@ -26,10 +41,46 @@ void init_default_dispatcher()
 
 /*------------------------------------------------------------------*/
 
+vk::PresentModeKHR to_vk_present_mode(const PresentMode present_mode)
+{
+    switch (present_mode)
+    {
+    case PresentMode::Mailbox:      return vk::PresentModeKHR::eMailbox;
+    case PresentMode::Immediate:    return vk::PresentModeKHR::eImmediate;
+    default:                        return vk::PresentModeKHR::eFifo;
+    }
+}
+
+/*------------------------------------------------------------------*/
+
+VulkanRenderer::~VulkanRenderer()
+{
+    if (!device_wrapper.device)
+        return;
+
+    device_wrapper.get().waitIdle();
+    deletion_queue.flush();
+
+    // Report descriptor pool usage, for tuning pool sizes:
+    const auto cache_stats = descriptor_set_cache.get_stats();
+    LOG_INFO("cached descriptor sets: {}, pools: {}, fragmentation: {:.2f}",
+        descriptor_set_cache.size(), cache_stats.pool_count, cache_stats.get_fragmentation());
+
+    for (const auto& stats : gpu_profiler.get_stats())
+        LOG_INFO("GPU '{}': avg {:.3f} ms, p50 {:.3f} ms, p95 {:.3f} ms, p99 {:.3f} ms, max {:.3f} ms ({} samples)",
+            stats.name, stats.average_ms, stats.p50_ms, stats.p95_ms, stats.p99_ms, stats.max_ms, stats.sample_count);
+}
+
 void VulkanRenderer::init(const VulkanRendererInitInfo& init_info)
 {
+    PROFILE_SCOPE("VulkanRenderer::init");
+
     init_default_dispatcher();
 
+    headless = !init_info.window;
+    if (headless)
+        LOG_INFO("headless rendering: {}x{} offscreen targets", init_info.headless_extent.width, init_info.headless_extent.height);
+
     /*------------------------------------------------------------------*/
     // Create instance:
 
@@ -42,8 +93,11 @@ void VulkanRenderer::init(const VulkanRendererInitInfo& init_info)
     std::vector<const char*> required_instance_extensions {
 
     };
-    for (auto cstr : vkfw::getRequiredInstanceExtensions())
-        required_instance_extensions.emplace_back(cstr);
+    if (!headless)
+    {
+        for (auto cstr : vkfw::getRequiredInstanceExtensions())
+            required_instance_extensions.emplace_back(cstr);
+    }
 
     const InstanceCreateInfo instance_createinfo {
         .application_name       = init_info.application_name,
@@ -65,66 +119,603 @@ void VulkanRenderer::init(const VulkanRendererInitInfo& init_info)
     /*------------------------------------------------------------------*/
     // Create surface:
 
-    surface = vkfw::createWindowSurfaceUnique(instance.get(), init_info.window);
+    if (!headless)
+        surface = vkfw::createWindowSurfaceUnique(instance.get(), init_info.window);
 
     /*------------------------------------------------------------------*/
     // Create device:
 
-    const std::vector<const char*> required_device_extensions {
-        VK_KHR_SWAPCHAIN_EXTENSION_NAME
-    };
+    std::vector<const char*> required_device_extensions;
+    if (!headless)
+        required_device_extensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
 
     const vk::PhysicalDeviceFeatures required_device_features {
-        .sampleRateShading = VK_TRUE,
-        .samplerAnisotropy = VK_TRUE,
+        .sampleRateShading          = VK_TRUE,
+        .samplerAnisotropy          = VK_TRUE,
+        .pipelineStatisticsQuery    = init_info.config.diagnostics_pipeline_statistics,
     };
     const DeviceCreateInfo device_createinfo {
-        .instance            = instance.get(),
-        .surface             = surface.get(),
-        .required_extensions = required_device_extensions,
-        .required_features   = required_device_features,
-        .debug_utils         = init_info.config.vulkan_debug >= VulkanDebug::On,
+        .instance               = instance.get(),
+        .surface                = surface.get(),
+        .required_extensions    = required_device_extensions,
+        .required_features      = required_device_features,
+        .debug_utils            = init_info.config.vulkan_debug >= VulkanDebug::On,
     };
     device_wrapper = create_device(device_createinfo);
     set_object_name(device_wrapper, device_wrapper.get(), "MainDevice");
 
     /*------------------------------------------------------------------*/
-    // Create swapchain:
+    // Create swapchain (or offscreen targets):
 
-    auto [width, height] = init_info.window.getSize();
-    on_resize(width, height);
+    present_mode = to_vk_present_mode(init_info.config.present_mode);
 
-    /*------------------------------------------------------------------*/
-    // Pipelines:
-
-    const vk::Format depth_stencil_format = device_wrapper.get_first_supported_format(
+    depth_stencil_format = device_wrapper.get_first_supported_format(
         { vk::Format::eD32Sfloat, vk::Format::eD32SfloatS8Uint, vk::Format::eD24UnormS8Uint },
         vk::ImageTiling::eOptimal,
         vk::FormatFeatureFlagBits::eDepthStencilAttachment
     );
+
+    if (headless)
+    {
+        on_resize(init_info.headless_extent.width, init_info.headless_extent.height);
+    }
+    else
+    {
+        auto [width, height] = init_info.window.getSize();
+        on_resize(width, height);
+    }
+    recreate_swapchain(); // The pipelines depend on its format.
+
+    /*------------------------------------------------------------------*/
+    // Pipelines:
     
+    const auto renderpass_type = headless ? RenderPassType::Offscreen : RenderPassType::ColorAndDepthStencil;
+
+    world_transform_path = init_info.config.diagnostics_uniform_camera ? WorldTransformPath::Uniform : WorldTransformPath::PushConstant;
+    if (world_transform_path == WorldTransformPath::Uniform)
+        LOG_INFO("uniform camera transform path");
+
     world_pipeline = create_world_pipeline(
         device_wrapper,
-        swapchain_wrapper.format,
+        get_color_format(),
         depth_stencil_format,
-        swapchain_wrapper.extent);
+        get_extent(),
+        WorldPipelineVariant::Default,
+        renderpass_type,
+        world_transform_path);
+
+    if (init_info.config.diagnostics_overdraw)
+    {
+        world_overdraw_pipeline = create_world_pipeline(
+            device_wrapper,
+            get_color_format(),
+            depth_stencil_format,
+            get_extent(),
+            WorldPipelineVariant::Overdraw,
+            renderpass_type,
+            world_transform_path);
+    }
+
+    create_framebuffers();
+
+    /*------------------------------------------------------------------*/
+    // Frames in flight:
+
+    // A single frame in flight makes the CPU wait for the GPU every frame, but input is then never more than a frame old when it reaches the screen:
+    const uint32_t frame_count = init_info.config.low_latency ? 1 : MAX_FRAMES_IN_FLIGHT;
+    if (init_info.config.low_latency)
+        LOG_INFO("low latency mode: 1 frame in flight");
+
+    for (uint32_t i = 0; i != frame_count; ++i)
+        frames.push_back(create_frame(device_wrapper, i));
+
+    gpu_profiler = GpuProfiler { device_wrapper, frame_count };
+    if (init_info.config.diagnostics_pipeline_statistics)
+        pipeline_statistics = PipelineStatisticsQuery { device_wrapper, frame_count };
+
+    /*------------------------------------------------------------------*/
+    // Per-frame uniforms:
+
+    descriptor_set_cache = DescriptorSetCache { device_wrapper };
+    uniform_ring = UniformRing { device_wrapper, frame_count, UNIFORM_RING_FRAME_SIZE };
+
+    // The only descriptor write; the per-frame location is selected with a dynamic offset at bind time:
+    std::vector<DescriptorBinding> frame_bindings {
+        DescriptorBinding {
+            .binding    = 0,
+            .type       = vk::DescriptorType::eUniformBufferDynamic,
+            .buffer     = uniform_ring.get_buffer(),
+            .offset     = 0,
+            .range      = sizeof(FrameData),
+        },
+    };
+    if (world_transform_path == WorldTransformPath::Uniform)
+    {
+        frame_bindings.push_back(DescriptorBinding {
+            .binding    = 1,
+            .type       = vk::DescriptorType::eUniformBufferDynamic,
+            .buffer     = uniform_ring.get_buffer(),
+            .offset     = 0,
+            .range      = sizeof(CameraData),
+        });
+    }
+    frame_descriptor_set = descriptor_set_cache.get(world_pipeline.descriptor_set_layout.get(), frame_bindings);
+
+    /*------------------------------------------------------------------*/
+    // Meshes:
+
+    if (init_info.scene)
+    {
+        PROFILE_SCOPE("upload scene");
+        meshes.reserve(init_info.scene->meshes.size());
+        for (const auto& mesh_data : init_info.scene->meshes)
+            meshes.push_back(create_mesh(device_wrapper, mesh_data));
+
+        // The scene does not move, so its instances are batched and uploaded once instead of every frame:
+        for (const auto& object : init_info.scene->objects)
+            static_batcher.add(meshes[object.mesh_index], InstanceData { .model = object.model });
+        static_batcher.build();
+        static_batcher.upload_static(device_wrapper);
+
+        LOG_INFO("scene: {} objects, {} meshes", init_info.scene->objects.size(), meshes.size());
+    }
+    else
+    {
+        meshes.push_back(create_mesh(device_wrapper, generate_cube()));
+    }
 }
 
 void VulkanRenderer::on_resize(const size_t width, const size_t height)
 {
     assert(device_wrapper.get());
-    assert(surface.get());
+    assert(headless || surface.get());
 
-    swapchain_wrapper = create_swapchain(
-        device_wrapper,
-        surface.get(),
-        vk::Extent2D { static_cast<uint32_t>(width), static_cast<uint32_t>(height) },
-        swapchain_wrapper.get()
-    );
+    // A minimized window has no extent to render to; frames are skipped until it has one again:
+    zero_extent = width == 0 || height == 0;
+    if (zero_extent)
+        return;
+
+    // A drag resizes many times per frame; only the latest size matters:
+    requested_extent = vk::Extent2D { static_cast<uint32_t>(width), static_cast<uint32_t>(height) };
+    swapchain_dirty = true;
 }
 
-void VulkanRenderer::update(const float elapsed_time)
+void VulkanRenderer::recreate_swapchain()
 {
-    
-    LOG_INFO("{}", elapsed_time);
+    PROFILE_FUNCTION();
+
+    swapchain_dirty = false;
+
+    vk::Extent2D extent = requested_extent;
+    if (!headless)
+    {
+        // The surface knows its current size better than the (possibly outdated) resize events; UINT32_MAX means the swapchain determines it:
+        const auto current_extent = device_wrapper.physical_device.getSurfaceCapabilitiesKHR(surface.get()).currentExtent;
+        if (current_extent.width != UINT32_MAX)
+            extent = current_extent;
+
+        zero_extent = extent.width == 0 || extent.height == 0;
+        if (zero_extent)
+            return;
+    }
+
+    // The current targets may still be used by frames in flight; they are destroyed once the frames submitted so far have completed.
+    // Views and framebuffers go first, as they are destroyed in push order:
+    const vk::SwapchainKHR old_swapchain = swapchain_wrapper.get();
+    deletion_queue.push(std::exchange(framebuffers, {}), frame_number);
+    deletion_queue.push(std::exchange(depth_stencil_image_view, {}), frame_number);
+    deletion_queue.push(std::exchange(depth_stencil_image, {}), frame_number);
+    deletion_queue.push(std::exchange(offscreen_color_image_view, {}), frame_number);
+    deletion_queue.push(std::exchange(offscreen_color_image, {}), frame_number);
+    deletion_queue.push(std::exchange(swapchain_wrapper, {}), frame_number); // Still valid as old_swapchain, until collected.
+
+    if (headless)
+    {
+        // The offscreen color target is (re)created along with the framebuffers:
+        headless_extent = extent;
+    }
+    else
+    {
+        swapchain_wrapper = create_swapchain(
+            device_wrapper,
+            surface.get(),
+            extent,
+            present_mode,
+            old_swapchain
+        );
+    }
+    LOG_DEBUG("swapchain rebuilt: {}x{} ({} resources pending deletion)", get_extent().width, get_extent().height, deletion_queue.size());
+
+    extent = get_extent();
+    camera.set_extent(static_cast<float>(extent.width), static_cast<float>(extent.height));
+
+    // On the initial call, framebuffers are created once the world pipeline (and its renderpass) exists:
+    if (world_pipeline.renderpass)
+        create_framebuffers();
+}
+
+vk::Format VulkanRenderer::get_color_format() const
+{
+    return headless ? OFFSCREEN_COLOR_FORMAT : swapchain_wrapper.format;
+}
+
+vk::Extent2D VulkanRenderer::get_extent() const
+{
+    return headless ? headless_extent : swapchain_wrapper.extent;
+}
+
+void VulkanRenderer::create_framebuffers()
+{
+    auto device = device_wrapper.get();
+    assert(device);
+    assert(world_pipeline.renderpass);
+
+    const auto extent = get_extent();
+
+    /*------------------------------------------------------------------*/
+    // Depth-stencil attachment:
+
+    framebuffers.clear();
+    depth_stencil_image_view.reset();
+
+    const ImageCreateInfo depth_stencil_createinfo {
+        .format         = depth_stencil_format,
+        .size           = extent,
+        .mip_levels     = 1,
+        .samples        = vk::SampleCountFlagBits::e1,
+        .usage          = vk::ImageUsageFlagBits::eDepthStencilAttachment,
+        .mem_properties = vk::MemoryPropertyFlagBits::eDeviceLocal,
+    };
+    depth_stencil_image = create_image(device_wrapper, depth_stencil_createinfo);
+    depth_stencil_image_view = create_image_view(device_wrapper, depth_stencil_image);
+    set_object_name(device_wrapper, depth_stencil_image.get(), "DepthStencilImage");
+
+    /*------------------------------------------------------------------*/
+    // Offscreen color attachment (headless only):
+
+    std::vector<vk::ImageView> color_views;
+    if (headless)
+    {
+        offscreen_color_image_view.reset();
+
+        const ImageCreateInfo color_createinfo {
+            .format         = OFFSCREEN_COLOR_FORMAT,
+            .size           = extent,
+            .mip_levels     = 1,
+            .samples        = vk::SampleCountFlagBits::e1,
+            .usage          = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,
+            .mem_properties = vk::MemoryPropertyFlagBits::eDeviceLocal,
+        };
+        offscreen_color_image = create_image(device_wrapper, color_createinfo);
+        offscreen_color_image_view = create_image_view(device_wrapper, offscreen_color_image);
+        set_object_name(device_wrapper, offscreen_color_image.get(), "OffscreenColorImage");
+
+        color_views.push_back(offscreen_color_image_view.get());
+    }
+    else
+    {
+        for (const auto& image_view : swapchain_wrapper.image_views)
+            color_views.push_back(image_view.get());
+    }
+
+    /*------------------------------------------------------------------*/
+    // Framebuffers:
+
+    for (size_t i = 0; i != color_views.size(); ++i)
+    {
+        const std::array<vk::ImageView, 2> attachments {
+            color_views[i],
+            depth_stencil_image_view.get(),
+        };
+
+        const vk::FramebufferCreateInfo createinfo {
+            .renderPass         = world_pipeline.renderpass.get(),
+            .attachmentCount    = static_cast<uint32_t>(attachments.size()),
+            .pAttachments       = attachments.data(),
+            .width              = extent.width,
+            .height             = extent.height,
+            .layers             = 1,
+        };
+        framebuffers.push_back(device.createFramebufferUnique(createinfo));
+        stats::add(stats::Counter::ObjectCreations);
+        set_object_name(device_wrapper, framebuffers.back().get(), fmt::format("Framebuffer_{}", i));
+    }
+}
+
+void VulkanRenderer::simulate(const double step)
+{
+    previous_simulation_time = simulation_time;
+    simulation_time += step;
+}
+
+void VulkanRenderer::wait_for_frame()
+{
+    PROFILE_SCOPE("wait for frame fence");
+
+    const auto wait_result = device_wrapper.get().waitForFences(std::vector<vk::Fence> { frames[frame_index].in_flight.get() }, VK_TRUE, UINT64_MAX);
+    if (wait_result != vk::Result::eSuccess)
+        THROW_ERROR("unexpected lack of success: {}", wait_result);
+}
+
+void VulkanRenderer::update(const float elapsed_time, const float interpolation)
+{
+    PROFILE_SCOPE("VulkanRenderer::update");
+
+    auto device = device_wrapper.get();
+    assert(device);
+
+    LOG_DEBUG_EVERY_MS(1000, "frame time: {:.3f} ms", elapsed_time * 10'000.f);
+    time = static_cast<float>(previous_simulation_time + (simulation_time - previous_simulation_time) * interpolation);
+
+    if (zero_extent)
+        return;
+
+    auto& frame = frames[frame_index];
+
+    /*------------------------------------------------------------------*/
+    // Wait until the GPU is done with this frame's resources (immediate if the caller already waited):
+
+    wait_for_frame();
+
+    // Frames complete in submission order, so every frame up to this frame's previous use of its slot has completed:
+    deletion_queue.collect(frame_number + 1 >= frames.size() ? frame_number + 1 - frames.size() : 0);
+
+    /*------------------------------------------------------------------*/
+    // Rebuild the swapchain, at most once per frame:
+
+    if (swapchain_dirty)
+    {
+        recreate_swapchain();
+        if (zero_extent)
+            return;
+    }
+
+    /*------------------------------------------------------------------*/
+    // Acquire swapchain image (headless rendering always uses the single offscreen target):
+
+    uint32_t image_index = 0;
+    if (!headless)
+    {
+        PROFILE_SCOPE("acquire");
+
+        // An out-of-date swapchain cannot be rendered to; the frame is skipped and the swapchain rebuilt on the next one. A suboptimal one still can:
+        try
+        {
+            const auto acquired = device.acquireNextImageKHR(
+                swapchain_wrapper.get(), UINT64_MAX, frame.image_available.get(), vk::Fence {});
+            image_index = acquired.value;
+            if (acquired.result == vk::Result::eSuboptimalKHR)
+                swapchain_dirty = true;
+        }
+        catch (const vk::OutOfDateKHRError&)
+        {
+            swapchain_dirty = true;
+            return;
+        }
+    }
+
+    device.resetFences(std::vector<vk::Fence> { frame.in_flight.get() });
+
+    // The frame's fence has been signaled, so its uniform region may be reused:
+    uniform_ring.begin_frame(static_cast<uint32_t>(frame_index));
+
+    /*------------------------------------------------------------------*/
+    // Record:
+
+    record_world(frame, image_index);
+
+    /*------------------------------------------------------------------*/
+    // Submit:
+
+    // Without presentation, there is nothing to wait on or signal besides the fence:
+    const vk::Semaphore render_finished = headless ? vk::Semaphore {} : swapchain_wrapper.render_finished[image_index].get();
+    const vk::PipelineStageFlags wait_stage = vk::PipelineStageFlagBits::eColorAttachmentOutput;
+    const vk::SubmitInfo submit_info {
+        .waitSemaphoreCount     = headless ? 0u : 1u,
+        .pWaitSemaphores        = &frame.image_available.get(),
+        .pWaitDstStageMask      = &wait_stage,
+        .commandBufferCount     = 1,
+        .pCommandBuffers        = &frame.cmdbuf.get(),
+        .signalSemaphoreCount   = headless ? 0u : 1u,
+        .pSignalSemaphores      = &render_finished,
+    };
+    {
+        PROFILE_SCOPE("submit");
+        device_wrapper.queues.graphics.submit(std::vector<vk::SubmitInfo> { submit_info }, frame.in_flight.get());
+        stats::add(stats::Counter::Submits);
+    }
+    ++frame_number;
+
+    // After a crash, the flight recorder shows the last frames which reached the GPU (formatted on the stack; no allocation):
+    char trace_event[64];
+    const auto trace_event_end = fmt::format_to_n(trace_event, sizeof(trace_event), "frame {} submitted; image: {}", frame_number, image_index);
+    record_trace_event({ trace_event, std::min(trace_event_end.size, sizeof(trace_event)) });
+
+    /*------------------------------------------------------------------*/
+    // Present:
+
+    if (!headless)
+    {
+        const auto swapchain = swapchain_wrapper.get();
+        const vk::PresentInfoKHR present_info {
+            .waitSemaphoreCount = 1,
+            .pWaitSemaphores    = &render_finished,
+            .swapchainCount     = 1,
+            .pSwapchains        = &swapchain,
+            .pImageIndices      = &image_index,
+        };
+        try
+        {
+            PROFILE_SCOPE("present");
+            const auto present_result = device_wrapper.queues.graphics.presentKHR(present_info);
+            if (present_result == vk::Result::eSuboptimalKHR)
+                swapchain_dirty = true;
+        }
+        catch (const vk::OutOfDateKHRError&)
+        {
+            swapchain_dirty = true;
+        }
+    }
+
+    frame_index = (frame_index + 1) % frames.size();
+
+    [[maybe_unused]] const auto frame_stats = stats::end_frame(); // Only read by a debug log, which is compiled out in Release.
+    LOG_DEBUG_EVERY_MS(5000, "frame stats: {} submits ({} blocking), {} barriers, {} draws, {} triangles, {} descriptor updates, {} object creations, {} allocations, {} bytes uploaded",
+        frame_stats.get(stats::Counter::Submits),
+        frame_stats.get(stats::Counter::BlockingSubmits),
+        frame_stats.get(stats::Counter::Barriers),
+        frame_stats.get(stats::Counter::Draws),
+        frame_stats.get(stats::Counter::Triangles),
+        frame_stats.get(stats::Counter::DescriptorUpdates),
+        frame_stats.get(stats::Counter::ObjectCreations),
+        frame_stats.get(stats::Counter::MemoryAllocations),
+        frame_stats.get(stats::Counter::BytesUploaded));
+}
+
+void VulkanRenderer::record_world(FrameWrapper& frame, const uint32_t image_index)
+{
+    PROFILE_FUNCTION();
+
+    auto device = device_wrapper.get();
+    assert(device);
+
+    const auto extent = get_extent();
+    auto cmdbuf = frame.cmdbuf.get();
+
+    /*------------------------------------------------------------------*/
+    // Collect dynamic instances (the static scene's were uploaded at init; without a scene, a spinning grid of cubes is drawn):
+
+    auto& batcher = frame.instance_batcher;
+    batcher.clear();
+
+    if (static_batcher.get_batches().empty())
+    {
+        const float spacing = 1.f / SCENE_GRID_SIZE;
+        const float offset  = -0.5f * spacing * (SCENE_GRID_SIZE - 1);
+        for (int x = 0; x != SCENE_GRID_SIZE; ++x)
+        {
+            for (int y = 0; y != SCENE_GRID_SIZE; ++y)
+            {
+                const glm::vec3 position { offset + x * spacing, offset + y * spacing, 0.f };
+                auto model = glm::translate(glm::mat4 { 1.f }, position);
+                model = glm::rotate(model, time + 0.1f * (x + y), glm::vec3 { 0.f, 0.f, 1.f });
+                model = glm::scale(model, glm::vec3 { 0.5f * spacing });
+                batcher.add(meshes.front(), InstanceData { .model = model });
+            }
+        }
+    }
+    batcher.build();
+    batcher.upload(device_wrapper);
+
+    BINLOG("frame {} recorded; image: {}, instances: {}, batches: {}",
+        frame_index, image_index,
+        static_batcher.get_instances().size() + batcher.get_instances().size(),
+        static_batcher.get_batches().size() + batcher.get_batches().size());
+
+    /*------------------------------------------------------------------*/
+    // Begin:
+
+    device.resetCommandPool(frame.command_pool.get(), vk::CommandPoolResetFlags {});
+    cmdbuf.begin(vk::CommandBufferBeginInfo { .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
+
+    // The frame's fence has been signaled, so the results of its previous use are available:
+    gpu_profiler.begin_frame(cmdbuf, static_cast<uint32_t>(frame_index));
+    pipeline_statistics.begin_frame(cmdbuf, static_cast<uint32_t>(frame_index));
+
+    if (pipeline_statistics.is_enabled())
+    {
+        const auto& stats = pipeline_statistics.get_latest();
+        LOG_INFO_EVERY_MS(1000, "world pass: {} vertex invocations, {} primitives after clipping, {} fragment invocations",
+            stats.vertex_shader_invocations, stats.clipping_primitives, stats.fragment_shader_invocations);
+    }
+
+    // The overdraw heatmap accumulates onto black:
+    const bool overdraw = static_cast<bool>(world_overdraw_pipeline.pipeline);
+    const auto& pipeline = overdraw ? world_overdraw_pipeline : world_pipeline;
+    const float background = overdraw ? 0.f : 0.05f;
+
+    const std::array<vk::ClearValue, 2> clear_values {
+        vk::ClearValue { vk::ClearColorValue { std::array<float, 4> { background, background, background, 1.f } } },
+        vk::ClearValue { vk::ClearDepthStencilValue { .depth = 1.f, .stencil = 0 } },
+    };
+    const vk::RenderPassBeginInfo renderpass_begininfo {
+        .renderPass         = world_pipeline.renderpass.get(),
+        .framebuffer        = framebuffers[image_index].get(),
+        .renderArea         = { .offset = { 0, 0 }, .extent = extent },
+        .clearValueCount    = static_cast<uint32_t>(clear_values.size()),
+        .pClearValues       = clear_values.data(),
+    };
+    const uint32_t world_pass_region = gpu_profiler.begin_region(cmdbuf, "world pass");
+    cmdbuf.beginRenderPass(renderpass_begininfo, vk::SubpassContents::eInline);
+    pipeline_statistics.begin(cmdbuf);
+
+    /*------------------------------------------------------------------*/
+    // Draw:
+
+    const vk::Viewport viewport {
+        .x          = 0.f,
+        .y          = 0.f,
+        .width      = static_cast<float>(extent.width),
+        .height     = static_cast<float>(extent.height),
+        .minDepth   = 0.f,
+        .maxDepth   = 1.f,
+    };
+    const vk::Rect2D scissor {
+        .offset = { 0, 0 },
+        .extent = extent,
+    };
+    cmdbuf.setViewport(0, { viewport });
+    cmdbuf.setScissor(0, { scissor });
+
+    cmdbuf.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline.pipeline.get());
+
+    const auto frame_data = uniform_ring.push(FrameData {
+        .time = glm::vec4 { time, 0.f, 0.f, 0.f },
+    });
+
+    if (world_transform_path == WorldTransformPath::Uniform)
+    {
+        const auto camera_data = uniform_ring.push(CameraData {
+            .view       = camera.get_view(),
+            .projection = camera.get_projection(),
+        });
+        cmdbuf.bindDescriptorSets(
+            vk::PipelineBindPoint::eGraphics,
+            pipeline.layout.get(),
+            0,
+            { frame_descriptor_set },
+            { frame_data.get_dynamic_offset(), camera_data.get_dynamic_offset() });
+    }
+    else
+    {
+        cmdbuf.bindDescriptorSets(
+            vk::PipelineBindPoint::eGraphics,
+            pipeline.layout.get(),
+            0,
+            { frame_descriptor_set },
+            { frame_data.get_dynamic_offset() });
+
+        // View-projection is multiplied once per frame here instead of per vertex; per-object transforms come from the instance stream:
+        const WorldPushConstants push_constants {
+            .view_projection = camera.get_view_projection(),
+        };
+        cmdbuf.pushConstants(
+            pipeline.layout.get(),
+            vk::ShaderStageFlagBits::eVertex,
+            0,
+            sizeof(WorldPushConstants),
+            &push_constants);
+    }
+
+    static_batcher.record(cmdbuf);
+    batcher.record(cmdbuf);
+
+    /*------------------------------------------------------------------*/
+    // End:
+
+    pipeline_statistics.end(cmdbuf);
+    cmdbuf.endRenderPass();
+    gpu_profiler.end_region(cmdbuf, world_pass_region);
+
+    cmdbuf.end();
 }
\ No newline at end of file
@@ -9,6 +9,15 @@
 #include "vulkan_device.h"
 #include "vulkan_swapchain.h"
 #include "vulkan_pipeline.h"
+#include "vulkan_frame.h"
+#include "vulkan_descriptor_allocator.h"
+#include "vulkan_uniform_ring.h"
+#include "vulkan_gpu_profiler.h"
+#include "vulkan_pipeline_statistics.h"
+#include "vulkan_stats.h"
+#include "vulkan_deletion_queue.h"
+#include "mesh.h"
+#include "scene.h"
 #include "camera.h"
 
 /*------------------------------------------------------------------*/
@@ -22,7 +31,9 @@ struct VulkanRendererInitInfo
     const Config&                   config;
     const std::string               application_name;
     const std::tuple<int, int, int> application_version; // <major, minor, patch>
-    const vkfw::Window&             window;
+    const vkfw::Window              window;             // Null for headless rendering (no GLFW, surface or swapchain).
+    const vk::Extent2D              headless_extent {}; // Size of the offscreen targets; only used if there is no window.
+    const vki::Scene*               scene = nullptr;    // Uploaded during init (need not outlive it); null renders the built-in test grid.
 };
 
 /*------------------------------------------------------------------*/
@@ -31,11 +42,35 @@ struct VulkanRendererInitInfo
 class VulkanRenderer
 {
 public:
+    ~VulkanRenderer(); // Waits for the device to become idle.
+
     void init(const VulkanRendererInitInfo& init_info);
-    void on_resize(const size_t width, const size_t height);
+    void on_resize(const size_t width, const size_t height); // Coalesced: the swapchain (or offscreen target) is rebuilt once, at the start of the next frame.
+
+    bool is_headless() const { return headless; }
+    bool has_extent() const { return !zero_extent; } // update() renders nothing otherwise.
+    std::string get_device_name() const { return device_wrapper.properties.deviceName; }
+    vki::Camera& get_camera() { return camera; } // E.g. for scripted camera paths; the extent is managed by the renderer.
 
-    void update(float elapsed_time);
+    // Advances the scene by one fixed simulation step (in seconds).
+    void simulate(const double step);
+    // Blocks until the next frame's resources are no longer used by the GPU. Optional (update() waits as well), but lets the caller sample input as late as possible before the frame is recorded.
+    void wait_for_frame();
+    // Renders a frame. The scene is interpolated between the previous and the current simulation step by interpolation (in [0; 1]).
+    void update(const float elapsed_time, const float interpolation = 1.f);
+
+    std::vector<vki::GpuRegionStats> get_gpu_stats() const { return gpu_profiler.get_stats(); }
+    vki::stats::Snapshot get_last_frame_stats() const { return vki::stats::get_last_frame(); }
+    vki::stats::Snapshot get_total_stats() const { return vki::stats::get_totals(); }
     
+private:
+    vk::Format get_color_format() const;
+    vk::Extent2D get_extent() const;
+
+    void recreate_swapchain();
+    void create_framebuffers();
+    void record_world(vki::FrameWrapper& frame, const uint32_t image_index);
+
 private:
     vk::UniqueInstance                  instance;
     vk::UniqueDebugUtilsMessengerEXT    debug_messenger;
@@ -43,7 +78,44 @@ private:
 
     vki::DeviceWrapper      device_wrapper;
     vki::SwapchainWrapper   swapchain_wrapper;
+    vk::PresentModeKHR      present_mode = vk::PresentModeKHR::eFifo;
+    bool                    zero_extent = false; // Set by resizing to a zero extent (e.g. when minimized); no frames are rendered until the next resize.
+
+    // Headless rendering replaces the surface and swapchain with a single offscreen color target:
+    bool                    headless = false;
+    vk::Extent2D            headless_extent;
+    vki::ImageWrapper       offscreen_color_image;
+    vk::UniqueImageView     offscreen_color_image_view;
+
+    vk::Format                          depth_stencil_format = vk::Format::eUndefined;
+    vki::ImageWrapper                   depth_stencil_image;
+    vk::UniqueImageView                 depth_stencil_image_view;
+    std::vector<vk::UniqueFramebuffer>  framebuffers; // One per swapchain image (or a single one, if headless).
+
+    // Rebuilds are requested by resizes and by out-of-date or suboptimal swapchains, and carried out once per frame:
+    bool                    swapchain_dirty = false;
+    vk::Extent2D            requested_extent;
+
 
     vki::PipelineWrapper world_pipeline;
+    vki::PipelineWrapper world_overdraw_pipeline; // Only created in overdraw diagnostics mode; replaces world_pipeline.
+    vki::WorldTransformPath world_transform_path = vki::WorldTransformPath::PushConstant; // Of both world pipelines.
     vki::Camera camera;
+
+    std::vector<vki::FrameWrapper>  frames; // Frames in flight (one in low latency mode).
+    size_t                          frame_index = 0;
+    uint64_t                        frame_number = 0; // Frames submitted so far.
+    vki::DeletionQueue              deletion_queue; // Resources replaced while frames in flight may still use them (e.g. by swapchain rebuilds).
+    vki::GpuProfiler                gpu_profiler;
+    vki::PipelineStatisticsQuery    pipeline_statistics; // Only enabled in pipeline statistics diagnostics mode.
+
+    vki::DescriptorSetCache         descriptor_set_cache; // Immutable sets.
+    vki::UniformRing                uniform_ring;
+    vk::DescriptorSet               frame_descriptor_set; // Written once; points into uniform_ring through a dynamic offset.
+
+    std::vector<vki::MeshWrapper>   meshes; // Never resized after init; the instance batcher keys batches by mesh address.
+    vki::InstanceBatcher            static_batcher; // Instances of the loaded scene; uploaded once (empty for the built-in test grid, whose instances move).
+    double                          simulation_time = 0.0;          // In seconds; of the current simulation step.
+    double                          previous_simulation_time = 0.0; // In seconds; of the previous simulation step.
+    float                           time = 0.f; // In seconds; interpolated between the last two simulation steps for the frame being recorded.
 };
\ No newline at end of file
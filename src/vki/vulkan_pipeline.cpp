@@ -3,25 +3,38 @@
 #include "vulkan_debug.h"
 #include "vulkan_assist.h"
 #include "vulkan_renderpass.h"
+#include "profiler.h"
+#include "vulkan_stats.h"
 
 namespace vki
 {
-vk::UniqueDescriptorSetLayout create_descriptor_set_layout(const DeviceWrapper& device_wrapper)
+vk::UniqueDescriptorSetLayout create_descriptor_set_layout(const DeviceWrapper& device_wrapper, const WorldTransformPath transform_path)
 {
     auto device = device_wrapper.get();
     assert(device);
 
+    // Per-frame data from the UniformRing, hence dynamic:
     const vk::DescriptorSetLayoutBinding ubo_layout_binding {
         .binding            = 0,
-        .descriptorType     = vk::DescriptorType::eUniformBuffer,
+        .descriptorType     = vk::DescriptorType::eUniformBufferDynamic,
         .descriptorCount    = 1,
-        .stageFlags         = vk::ShaderStageFlagBits::eVertex,
+        .stageFlags         = vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment,
     };
 
-    const std::vector<vk::DescriptorSetLayoutBinding> bindings {
+    std::vector<vk::DescriptorSetLayoutBinding> bindings {
         ubo_layout_binding,
     };
 
+    if (transform_path == WorldTransformPath::Uniform)
+    {
+        bindings.push_back(vk::DescriptorSetLayoutBinding {
+            .binding            = 1,
+            .descriptorType     = vk::DescriptorType::eUniformBufferDynamic,
+            .descriptorCount    = 1,
+            .stageFlags         = vk::ShaderStageFlagBits::eVertex,
+        });
+    }
+
     const vk::DescriptorSetLayoutCreateInfo createinfo {
         .bindingCount   = static_cast<uint32_t>(bindings.size()),
         .pBindings      = bindings.data()
@@ -30,19 +43,28 @@ vk::UniqueDescriptorSetLayout create_descriptor_set_layout(const DeviceWrapper&
 }
 
 PipelineWrapper create_world_pipeline(
-    const DeviceWrapper&    device_wrapper,
-    const vk::Format        color_format,
-    const vk::Format        depth_stencil_format,
-    const vk::Extent2D      initial_extent)
+    const DeviceWrapper&            device_wrapper,
+    const vk::Format                color_format,
+    const vk::Format                depth_stencil_format,
+    const vk::Extent2D              initial_extent,
+    const WorldPipelineVariant      variant,
+    const RenderPassType            renderpass_type,
+    const WorldTransformPath        transform_path)
 {
+    PROFILE_FUNCTION();
+
     auto device = device_wrapper.get();
     assert(device);
 
     /*------------------------------------------------------------------*/
     // Shader stages:
 
-    auto vert_shader_module = create_shader_module(device_wrapper, "assets/shaders/world.vert.spv");
-    auto frag_shader_module = create_shader_module(device_wrapper, "assets/shaders/world.frag.spv");
+    const bool overdraw = variant == WorldPipelineVariant::Overdraw;
+
+    auto vert_shader_module = create_shader_module(device_wrapper,
+        transform_path == WorldTransformPath::Uniform ? "assets/shaders/world_uniform_camera.vert.spv" : "assets/shaders/world.vert.spv");
+    auto frag_shader_module = create_shader_module(device_wrapper,
+        overdraw ? "assets/shaders/overdraw.frag.spv" : "assets/shaders/world.frag.spv");
     
     const vk::PipelineShaderStageCreateInfo vert_shader_createinfo {
         .stage  = vk::ShaderStageFlagBits::eVertex,
@@ -64,12 +86,19 @@ PipelineWrapper create_world_pipeline(
     /*------------------------------------------------------------------*/
     // Fixed function state:
 
-    const auto binding_description    = Vertex::get_binding_description();
-    const auto attribute_descriptions = Vertex::get_attribute_descriptions();
+    // Binding 0 is per-vertex, binding 1 is per-instance:
+    const std::vector<vk::VertexInputBindingDescription> binding_descriptions {
+        Vertex::get_binding_description(),
+        InstanceData::get_binding_description(),
+    };
+
+    auto attribute_descriptions = Vertex::get_attribute_descriptions();
+    for (const auto& description : InstanceData::get_attribute_descriptions())
+        attribute_descriptions.push_back(description);
 
     const vk::PipelineVertexInputStateCreateInfo vertex_input_createinfo {
-        .vertexBindingDescriptionCount      = 1,
-        .pVertexBindingDescriptions         = &binding_description,
+        .vertexBindingDescriptionCount      = static_cast<uint32_t>(binding_descriptions.size()),
+        .pVertexBindingDescriptions         = binding_descriptions.data(),
         .vertexAttributeDescriptionCount    = static_cast<uint32_t>(attribute_descriptions.size()),
         .pVertexAttributeDescriptions       = attribute_descriptions.data(),
     };
@@ -120,19 +149,25 @@ PipelineWrapper create_world_pipeline(
         .minSampleShading       = 0.f,
     };
 
-    // Depth and stencil testing:
+    // Depth and stencil testing (overdraw counts every fragment, including hidden ones):
     const vk::PipelineDepthStencilStateCreateInfo depth_stencil_createinfo {
-        .depthTestEnable    = VK_TRUE,
-        .depthWriteEnable   = VK_TRUE,
+        .depthTestEnable    = overdraw ? VK_FALSE : VK_TRUE,
+        .depthWriteEnable   = overdraw ? VK_FALSE : VK_TRUE,
         .depthCompareOp     = vk::CompareOp::eLess,
         .stencilTestEnable  = VK_FALSE,
     };
 
-    // Color blend:
+    // Color blend (overdraw accumulates: dst = src + dst):
     const vk::PipelineColorBlendAttachmentState color_blend_attachment {
-        .blendEnable    = VK_FALSE,
-        .colorWriteMask = vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG |
-                          vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA
+        .blendEnable            = overdraw ? VK_TRUE : VK_FALSE,
+        .srcColorBlendFactor    = vk::BlendFactor::eOne,
+        .dstColorBlendFactor    = vk::BlendFactor::eOne,
+        .colorBlendOp           = vk::BlendOp::eAdd,
+        .srcAlphaBlendFactor    = vk::BlendFactor::eOne,
+        .dstAlphaBlendFactor    = vk::BlendFactor::eZero,
+        .alphaBlendOp           = vk::BlendOp::eAdd,
+        .colorWriteMask         = vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG |
+                                  vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA
     };
 
     const vk::PipelineColorBlendStateCreateInfo color_blend_createinfo {
@@ -157,11 +192,19 @@ PipelineWrapper create_world_pipeline(
     /*------------------------------------------------------------------*/
     // Pipeline layout:
 
-    auto descriptor_set_layout = create_descriptor_set_layout(device_wrapper);
+    auto descriptor_set_layout = create_descriptor_set_layout(device_wrapper, transform_path);
+
+    const vk::PushConstantRange push_constant_range {
+        .stageFlags = vk::ShaderStageFlagBits::eVertex,
+        .offset     = 0,
+        .size       = sizeof(WorldPushConstants),
+    };
 
     const vk::PipelineLayoutCreateInfo pipeline_layout_createinfo {
-        .setLayoutCount = 1,
-        .pSetLayouts    = &descriptor_set_layout.get(),
+        .setLayoutCount         = 1,
+        .pSetLayouts            = &descriptor_set_layout.get(),
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges    = &push_constant_range,
     };
     auto pipeline_layout = device.createPipelineLayoutUnique(pipeline_layout_createinfo);
 
@@ -172,7 +215,7 @@ PipelineWrapper create_world_pipeline(
         device_wrapper,
         color_format,
         depth_stencil_format,
-        RenderPassType::ColorAndDepthStencil);
+        renderpass_type);
 
     /*------------------------------------------------------------------*/
     // Create
@@ -193,7 +236,8 @@ PipelineWrapper create_world_pipeline(
         .subpass                = 0,
     };
     auto [result, pipeline] = device.createGraphicsPipelineUnique(nullptr, createinfo);
-    set_object_name(device_wrapper, pipeline.get(), "WorldPipeline");
+    stats::add(stats::Counter::ObjectCreations);
+    set_object_name(device_wrapper, pipeline.get(), overdraw ? "WorldOverdrawPipeline" : "WorldPipeline");
     
     if (result == vk::Result::ePipelineCompileRequiredEXT)
         LOG_WARNING("compile required but not requested by application");
@@ -203,6 +247,7 @@ PipelineWrapper create_world_pipeline(
 
     return PipelineWrapper {
         .pipeline               = std::move(pipeline),
+        .layout                 = std::move(pipeline_layout),
         .descriptor_set_layout  = std::move(descriptor_set_layout),
         .renderpass             = std::move(renderpass),
     };
@@ -4,19 +4,60 @@
 
 #include "vertex.h"
 #include "vulkan_device.h"
+#include "vulkan_renderpass.h"
 
 namespace vki
 {
+// Pushed once per frame (must not exceed the guaranteed minimum of 128 bytes of push constant storage). Per-object transforms are provided by the instance stream (see also: vulkan_instancing.h).
+struct WorldPushConstants
+{
+    glm::mat4 view_projection;
+};
+static_assert(sizeof(WorldPushConstants) <= 128);
+
+// Per-frame constants (set 0, binding 0; read by world.frag, whose block must match this layout). The camera matrices are not duplicated here; they only reach the shaders through WorldPushConstants. Allocated from the UniformRing every frame and bound through a dynamic offset.
+struct FrameData
+{
+    glm::vec4 time; // x: seconds since start
+};
+static_assert(sizeof(FrameData) == 16);
+
+// View and projection for WorldTransformPath::Uniform (set 0, binding 1; read by world_uniform_camera.vert, whose block must match this layout). Allocated from the UniformRing every frame, like FrameData.
+struct CameraData
+{
+    glm::mat4 view;
+    glm::mat4 projection;
+};
+
 struct PipelineWrapper
 {
     vk::UniquePipeline              pipeline;
+    vk::UniquePipelineLayout        layout;
     vk::UniqueDescriptorSetLayout   descriptor_set_layout;
     vk::UniqueRenderPass            renderpass;
 };
 
+enum class WorldPipelineVariant
+{
+    Default,
+    Overdraw,   // Debug heatmap: no depth test, additive blending of a constant per fragment (see: overdraw.frag).
+};
+
+// How world.vert gets from object to clip space. Both paths take the model matrix from the instance stream.
+enum class WorldTransformPath
+{
+    PushConstant,   // View-projection is multiplied once per frame on the CPU and pushed (see: WorldPushConstants).
+    Uniform,        // View and projection are read from a uniform buffer and multiplied per vertex (see: CameraData). This is the path that WorldPushConstants replaced; it is only kept to compare the two (see: rcl-perf --transform).
+};
+
+// Set 0: per-frame data (see: FrameData), and in WorldTransformPath::Uniform the camera (see: CameraData).
+// All variants have compatible layouts and renderpasses, so descriptor sets and framebuffers may be shared between them.
 PipelineWrapper create_world_pipeline(
-    const DeviceWrapper&    device_wrapper,
-    const vk::Format        color_format,
-    const vk::Format        depth_stencil_format,
-    const vk::Extent2D      initial_extent);
+    const DeviceWrapper&            device_wrapper,
+    const vk::Format                color_format,
+    const vk::Format                depth_stencil_format,
+    const vk::Extent2D              initial_extent,
+    const WorldPipelineVariant      variant = WorldPipelineVariant::Default,
+    const RenderPassType            renderpass_type = RenderPassType::ColorAndDepthStencil,
+    const WorldTransformPath        transform_path = WorldTransformPath::PushConstant);
 }
\ No newline at end of file
@@ -0,0 +1,95 @@
+#include "vulkan_pipeline_statistics.h"
+
+#include "log.h"
+#include "vulkan_debug.h"
+#include "vulkan_stats.h"
+
+namespace vki
+{
+/*------------------------------------------------------------------*/
+// Constants:
+
+// Results are written in the order of the flag bits:
+const vk::QueryPipelineStatisticFlags STATISTIC_FLAGS =
+    vk::QueryPipelineStatisticFlagBits::eInputAssemblyVertices |
+    vk::QueryPipelineStatisticFlagBits::eInputAssemblyPrimitives |
+    vk::QueryPipelineStatisticFlagBits::eVertexShaderInvocations |
+    vk::QueryPipelineStatisticFlagBits::eClippingInvocations |
+    vk::QueryPipelineStatisticFlagBits::eClippingPrimitives |
+    vk::QueryPipelineStatisticFlagBits::eFragmentShaderInvocations;
+const uint32_t STATISTIC_COUNT = 6;
+
+/*------------------------------------------------------------------*/
+
+PipelineStatisticsQuery::PipelineStatisticsQuery(const DeviceWrapper& device_wrapper, const uint32_t frame_count)
+{
+    device = device_wrapper.get();
+    assert(device);
+    assert(frame_count > 0);
+    assert(device_wrapper.enabled_features.pipelineStatisticsQuery);
+
+    const vk::QueryPoolCreateInfo query_pool_createinfo {
+        .queryType          = vk::QueryType::ePipelineStatistics,
+        .queryCount         = 1,
+        .pipelineStatistics = STATISTIC_FLAGS,
+    };
+    for (uint32_t i = 0; i != frame_count; ++i)
+    {
+        query_pools.push_back(device.createQueryPoolUnique(query_pool_createinfo));
+        stats::add(stats::Counter::ObjectCreations);
+        set_object_name(device_wrapper, query_pools.back().get(), fmt::format("PipelineStatisticsQueryPool_{}", i));
+    }
+    recorded.resize(frame_count, false);
+}
+
+void PipelineStatisticsQuery::begin_frame(const vk::CommandBuffer cmdbuf, const uint32_t frame_index)
+{
+    if (!is_enabled())
+        return;
+
+    assert(frame_index < query_pools.size());
+    current_frame = frame_index;
+
+    if (recorded[frame_index])
+    {
+        // The statistics are followed by the availability; nothing is waited for:
+        std::array<uint64_t, STATISTIC_COUNT + 1> results {};
+        const auto result = device.getQueryPoolResults(
+            query_pools[frame_index].get(), 0, 1,
+            sizeof(results), results.data(), sizeof(results),
+            vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWithAvailability);
+
+        if (result == vk::Result::eSuccess && results[STATISTIC_COUNT] != 0)
+        {
+            latest = PipelineStatistics {
+                .input_assembly_vertices        = results[0],
+                .input_assembly_primitives      = results[1],
+                .vertex_shader_invocations      = results[2],
+                .clipping_invocations           = results[3],
+                .clipping_primitives            = results[4],
+                .fragment_shader_invocations    = results[5],
+            };
+        }
+        recorded[frame_index] = false;
+    }
+
+    cmdbuf.resetQueryPool(query_pools[frame_index].get(), 0, 1);
+}
+
+void PipelineStatisticsQuery::begin(const vk::CommandBuffer cmdbuf)
+{
+    if (!is_enabled())
+        return;
+
+    cmdbuf.beginQuery(query_pools[current_frame].get(), 0, vk::QueryControlFlags {});
+}
+
+void PipelineStatisticsQuery::end(const vk::CommandBuffer cmdbuf)
+{
+    if (!is_enabled())
+        return;
+
+    cmdbuf.endQuery(query_pools[current_frame].get(), 0);
+    recorded[current_frame] = true;
+}
+}
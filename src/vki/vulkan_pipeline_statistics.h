@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+#include "vulkan_device.h"
+
+namespace vki
+{
+/*------------------------------------------------------------------*/
+// PipelineStatisticsQuery:
+
+struct PipelineStatistics
+{
+    uint64_t input_assembly_vertices     = 0;
+    uint64_t input_assembly_primitives   = 0;
+    uint64_t vertex_shader_invocations   = 0;
+    uint64_t clipping_invocations        = 0;
+    uint64_t clipping_primitives         = 0; // Primitives which survived clipping.
+    uint64_t fragment_shader_invocations = 0;
+};
+
+// Wraps a pass in a pipeline statistics query. Like GpuProfiler, each frame in flight has its own query pool, and results are read back (without waiting) the next time the same frame begins.
+// Requires the pipelineStatisticsQuery device feature.
+class PipelineStatisticsQuery
+{
+public:
+    PipelineStatisticsQuery() = default;
+    PipelineStatisticsQuery(const DeviceWrapper& device_wrapper, const uint32_t frame_count);
+
+    // Reads back the frame's previous results and resets its query. Must only be called once the frame's fence has been signaled, with cmdbuf in the recording state and outside of a render pass.
+    void begin_frame(const vk::CommandBuffer cmdbuf, const uint32_t frame_index);
+
+    // Once per frame, around the measured pass:
+    void begin(const vk::CommandBuffer cmdbuf);
+    void end(const vk::CommandBuffer cmdbuf);
+
+    // Of the most recently read back frame.
+    const PipelineStatistics& get_latest() const { return latest; }
+    bool is_enabled() const { return !query_pools.empty(); }
+
+private:
+    vk::Device                          device;
+    std::vector<vk::UniqueQueryPool>    query_pools;
+    std::vector<bool>                   recorded; // Whether the pool's query was recorded since its last read back.
+    uint32_t                            current_frame = 0;
+    PipelineStatistics                  latest;
+};
+}
@@ -6,7 +6,7 @@ vk::UniqueRenderPass create_renderpass(
     const DeviceWrapper&    device_wrapper,
     const vk::Format        color_format,
     const vk::Format        depth_stencil_format,
-    const RenderPassType    /*type*/)
+    const RenderPassType    type)
 {
     auto device = device_wrapper.get();
     assert(device);
@@ -23,7 +23,9 @@ vk::UniqueRenderPass create_renderpass(
         .stencilLoadOp  = vk::AttachmentLoadOp::eDontCare,
         .stencilStoreOp = vk::AttachmentStoreOp::eDontCare,
         .initialLayout  = vk::ImageLayout::eUndefined,
-        .finalLayout    = vk::ImageLayout::ePresentSrcKHR,
+        .finalLayout    = type == RenderPassType::Offscreen ?
+                            vk::ImageLayout::eTransferSrcOptimal :
+                            vk::ImageLayout::ePresentSrcKHR,
     };
 
     // Depth-Stencil:
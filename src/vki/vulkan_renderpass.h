@@ -11,13 +11,15 @@ namespace vki
 
 enum class RenderPassType
 {
-    ColorAndDepthStencil,
+    ColorAndDepthStencil,   // Color ends in ePresentSrcKHR, for swapchain images.
+    Offscreen,              // Color ends in eTransferSrcOptimal, for offscreen images which are read back or copied.
 };
 
+// Renderpasses of different types are compatible with each other (they only differ in final layouts).
 vk::UniqueRenderPass create_renderpass(
     const DeviceWrapper&    device_wrapper,
     const vk::Format        color_format,
     const vk::Format        depth_stencil_format,
-    const RenderPassType    /*type*/);
+    const RenderPassType    type);
 
 }
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include "vulkan_stats.h"
+
+#include <atomic>
+#include <mutex>
+
+namespace vki::stats
+{
+/*------------------------------------------------------------------*/
+// State:
+
+struct State
+{
+    std::array<std::atomic<uint64_t>, COUNTER_COUNT> current {};
+
+    std::mutex  snapshot_mutex;
+    Snapshot    last_frame;
+    Snapshot    totals;
+};
+
+State& get_state()
+{
+    static State state;
+    return state;
+}
+
+/*------------------------------------------------------------------*/
+
+const char* get_name(const Counter counter)
+{
+    switch (counter)
+    {
+    case Counter::Submits:              return "submits";
+    case Counter::BlockingSubmits:      return "blocking_submits";
+    case Counter::Barriers:             return "barriers";
+    case Counter::Draws:                return "draws";
+    case Counter::Triangles:            return "triangles";
+    case Counter::DescriptorUpdates:    return "descriptor_updates";
+    case Counter::ObjectCreations:      return "object_creations";
+    case Counter::MemoryAllocations:    return "memory_allocations";
+    case Counter::BytesUploaded:        return "bytes_uploaded";
+    case Counter::COUNT:                break;
+    }
+    return "unknown";
+}
+
+void add(const Counter counter, const uint64_t value)
+{
+    get_state().current[static_cast<size_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+}
+
+Snapshot end_frame()
+{
+    auto& state = get_state();
+
+    Snapshot frame { .frame_count = 1 };
+    for (size_t i = 0; i != COUNTER_COUNT; ++i)
+        frame.values[i] = state.current[i].exchange(0, std::memory_order_relaxed);
+
+    std::lock_guard lock { state.snapshot_mutex };
+    state.last_frame = frame;
+    for (size_t i = 0; i != COUNTER_COUNT; ++i)
+        state.totals.values[i] += frame.values[i];
+    ++state.totals.frame_count;
+
+    return frame;
+}
+
+Snapshot get_last_frame()
+{
+    auto& state = get_state();
+    std::lock_guard lock { state.snapshot_mutex };
+    return state.last_frame;
+}
+
+Snapshot get_totals()
+{
+    auto& state = get_state();
+    std::lock_guard lock { state.snapshot_mutex };
+    return state.totals;
+}
+}
+
+/*------------------------------------------------------------------*/
+// doctest:
+
+#include <doctest/doctest.h>
+
+TEST_CASE("testing renderer stats frames")
+{
+    using namespace vki::stats;
+
+    const auto totals_before = get_totals();
+    end_frame(); // Discard counts of anything that ran before the test.
+
+    add(Counter::Draws);
+    add(Counter::Triangles, 12);
+    const auto frame = end_frame();
+    CHECK(frame.get(Counter::Draws) == 1);
+    CHECK(frame.get(Counter::Triangles) == 12);
+    CHECK(get_last_frame().get(Counter::Triangles) == 12);
+
+    CHECK(end_frame().get(Counter::Draws) == 0);
+    CHECK(get_totals().frame_count == totals_before.frame_count + 3);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace vki
+{
+/*------------------------------------------------------------------*/
+// Renderer statistics:
+// stats::add(stats::Counter::Draws);
+// Counters are process-wide relaxed atomics, so they may be incremented from any thread at the cost of a single uncontended atomic add. The renderer calls stats::end_frame() once per frame, which moves the running counts into the "last frame" snapshot and the totals.
+
+namespace stats
+{
+enum class Counter
+{
+    Submits,            // Queue submissions, including blocking ones.
+    BlockingSubmits,    // Submissions the CPU waited on (SingleTimeCommandBuffer).
+    Barriers,           // Pipeline barrier commands.
+    Draws,              // Draw commands.
+    Triangles,
+    DescriptorUpdates,  // Descriptors written.
+    ObjectCreations,    // Buffers, images, views, pipelines, query pools...
+    MemoryAllocations,  // vkAllocateMemory calls.
+    BytesUploaded,      // Host to device: staging copies and writes to host visible buffers used by the GPU.
+
+    COUNT
+};
+constexpr size_t COUNTER_COUNT = static_cast<size_t>(Counter::COUNT);
+
+// Lowercase, underscore-separated; suitable as a metric name.
+const char* get_name(const Counter counter);
+
+struct Snapshot
+{
+    std::array<uint64_t, COUNTER_COUNT> values {};
+    uint64_t frame_count = 0; // Frames covered by the snapshot.
+
+    uint64_t get(const Counter counter) const { return values[static_cast<size_t>(counter)]; }
+};
+
+void add(const Counter counter, const uint64_t value = 1);
+
+// Ends the current frame; returns its counts. Counts added by other threads during the call are attributed to either frame.
+Snapshot end_frame();
+
+// Thread-safe; copies.
+Snapshot get_last_frame();
+Snapshot get_totals(); // Of all ended frames.
+}
+}
@@ -3,6 +3,7 @@
 #include "utility.h"
 #include "vulkan_assist.h"
 #include "vulkan_debug.h"
+#include "profiler.h"
 
 namespace vki
 {
@@ -10,8 +11,11 @@ SwapchainWrapper create_swapchain(
     const DeviceWrapper&    device_wrapper,
     const vk::SurfaceKHR    surface,
     vk::Extent2D            extent,
+    vk::PresentModeKHR      present_mode,
     vk::SwapchainKHR        old_swapchain)
 {
+    PROFILE_FUNCTION();
+
     auto device         = device_wrapper.device.get();
     auto command_pool   = device_wrapper.command_pools.graphics.get();
     auto graphics_queue = device_wrapper.queues.graphics;
@@ -50,8 +54,12 @@ SwapchainWrapper create_swapchain(
     if (!preferred_format_found)
         LOG_WARNING("preferred vulkan surface format not found; using first available format instead");
 
-    // Presentation mode:
+    // Presentation mode (FIFO support is required by the specification):
     vk::PresentModeKHR presentation_mode = vk::PresentModeKHR::eFifo;
+    if (contains(surface_presentation_modes, present_mode))
+        presentation_mode = present_mode;
+    else
+        LOG_WARNING("vulkan present mode {} not supported; using FIFO instead", vk::to_string(present_mode));
 
     // Image count (+1 to assure we always have a free image to render to):
     uint32_t image_count = surface_capabilities.minImageCount + 1;
@@ -105,7 +113,9 @@ SwapchainWrapper create_swapchain(
     auto images = device.getSwapchainImagesKHR(swapchain.get());
 
     std::vector<vk::UniqueImageView> image_views;
+    std::vector<vk::UniqueSemaphore> render_finished;
     image_views.reserve(images.size());
+    render_finished.reserve(images.size());
     for (const auto image : images)
     {
         vk::ImageViewCreateInfo view_createinfo {
@@ -115,6 +125,7 @@ SwapchainWrapper create_swapchain(
             .subresourceRange   = create_ISR(vk::ImageAspectFlagBits::eColor),
         };
         image_views.push_back(device.createImageViewUnique(view_createinfo));
+        render_finished.push_back(device.createSemaphoreUnique(vk::SemaphoreCreateInfo {}));
     }
 
     for (int i = 0; i != images.size(); ++i)
@@ -124,18 +135,20 @@ SwapchainWrapper create_swapchain(
 
         set_object_name(device_wrapper, image, fmt::format("SwapChainImage_{}", i));
         set_object_name(device_wrapper, image_view, fmt::format("SwapChainImageView_{}", i));
+        set_object_name(device_wrapper, render_finished[i].get(), fmt::format("SwapChainRenderFinished_{}", i));
     }
     
     /*------------------------------------------------------------------*/
     // Return:
 
     return SwapchainWrapper {
-        .swapchain   = std::move(swapchain),
-        .format      = std::move(surface_format.format),
-        .colorspace  = std::move(surface_format.colorSpace),
-        .extent      = std::move(extent),
-        .images      = std::move(images),
-        .image_views = std::move(image_views),
+        .swapchain       = std::move(swapchain),
+        .format          = std::move(surface_format.format),
+        .colorspace      = std::move(surface_format.colorSpace),
+        .extent          = std::move(extent),
+        .images          = std::move(images),
+        .image_views     = std::move(image_views),
+        .render_finished = std::move(render_finished),
     };
 }
 }
\ No newline at end of file
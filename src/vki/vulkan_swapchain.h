@@ -18,6 +18,7 @@ struct SwapchainWrapper
     
     std::vector<vk::Image>              images;
     std::vector<vk::UniqueImageView>    image_views;
+    std::vector<vk::UniqueSemaphore>    render_finished; // Per image, not per frame in flight: the presentation engine may still wait on an image's semaphore when the next frame is submitted, but not once the image has been acquired again.
     
     vk::SwapchainKHR get() { return swapchain.get(); }
 };
@@ -26,6 +27,7 @@ SwapchainWrapper create_swapchain(
     const DeviceWrapper&    device_wrapper,
     const vk::SurfaceKHR    surface,
     vk::Extent2D            extent,
+    vk::PresentModeKHR      present_mode = vk::PresentModeKHR::eFifo, // Falls back to eFifo if not supported.
     vk::SwapchainKHR        old_swapchain = vk::SwapchainKHR {});
 
 }
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include "vulkan_uniform_ring.h"
+
+#include "utility.h"
+#include "error.h"
+#include "vulkan_debug.h"
+#include "vulkan_stats.h"
+
+namespace vki
+{
+UniformRing::UniformRing(const DeviceWrapper& device_wrapper, const uint32_t frame_count, const vk::DeviceSize frame_size)
+{
+    auto device = device_wrapper.get();
+    assert(device);
+    assert(frame_count > 0);
+
+    const auto& limits = device_wrapper.properties.limits;
+    alignment = std::max(limits.minUniformBufferOffsetAlignment, limits.minStorageBufferOffsetAlignment);
+
+    // Every frame region has to start at an aligned offset:
+    this->frame_size = align_up(frame_size, alignment);
+
+    buffer_wrapper = create_buffer(
+        device_wrapper,
+        this->frame_size * frame_count,
+        vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eStorageBuffer,
+        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+    set_object_name(device_wrapper, buffer_wrapper.get(), "UniformRing");
+
+    // Persistently mapped; unmapped implicitly when the memory is freed:
+    mapped = static_cast<std::byte*>(device.mapMemory(buffer_wrapper.memory.get(), 0, VK_WHOLE_SIZE));
+}
+
+void UniformRing::begin_frame(const uint32_t frame_index)
+{
+    assert(mapped);
+    assert((frame_index + 1) * frame_size <= buffer_wrapper.size);
+
+    frame_begin = frame_index * frame_size;
+    head        = frame_begin;
+}
+
+UniformRing::Allocation UniformRing::allocate(const vk::DeviceSize size)
+{
+    assert(mapped);
+
+    const vk::DeviceSize offset = align_up(head, alignment);
+    if (offset + size > frame_begin + frame_size)
+        THROW_ERROR("uniform ring frame region exhausted; requested: {}, used: {}, frame size: {}",
+            size, head - frame_begin, frame_size);
+
+    head = offset + size;
+    stats::add(stats::Counter::BytesUploaded, size); // Written by the caller.
+
+    return Allocation {
+        .data   = mapped + offset,
+        .offset = offset,
+        .size   = size,
+    };
+}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+#include "vulkan_assist.h"
+#include "vulkan_device.h"
+
+namespace vki
+{
+/*------------------------------------------------------------------*/
+// UniformRing:
+
+// A persistently mapped, host visible buffer split into one region per frame in flight. Each region is a linear allocator handing out aligned sub-ranges, meant to be bound through eUniformBufferDynamic (or eStorageBufferDynamic) descriptors: the descriptor is written once, and only the dynamic offset changes per allocation.
+class UniformRing
+{
+public:
+    struct Allocation
+    {
+        void*           data;
+        vk::DeviceSize  offset; // Offset into the ring buffer; use as the dynamic offset.
+        vk::DeviceSize  size;
+
+        uint32_t get_dynamic_offset() const { return static_cast<uint32_t>(offset); }
+    };
+
+    UniformRing() = default;
+    UniformRing(const DeviceWrapper& device_wrapper, const uint32_t frame_count, const vk::DeviceSize frame_size);
+
+    // Resets the region of the given frame. Must only be called once the frame's fence has been signaled.
+    void begin_frame(const uint32_t frame_index);
+
+    // Throws if the current frame's region is exhausted.
+    Allocation allocate(const vk::DeviceSize size);
+
+    template<typename T>
+    Allocation push(const T& data)
+    {
+        auto allocation = allocate(sizeof(T));
+        std::memcpy(allocation.data, &data, sizeof(T));
+        return allocation;
+    }
+
+    vk::Buffer      get_buffer() const { return buffer_wrapper.get(); }
+    vk::DeviceSize  get_alignment() const { return alignment; }
+    vk::DeviceSize  get_frame_size() const { return frame_size; }
+
+    vk::DeviceSize  get_used_size() const { return head - frame_begin; } // Of the current frame.
+
+private:
+    BufferWrapper   buffer_wrapper;
+    std::byte*      mapped      = nullptr;
+    vk::DeviceSize  alignment   = 0;
+    vk::DeviceSize  frame_size  = 0;
+
+    vk::DeviceSize  frame_begin = 0;
+    vk::DeviceSize  head        = 0;
+};
+}